@@ -0,0 +1,82 @@
+/**
+ * buffer_pool_manager_benchmark.cpp
+ *
+ * Throughput of FetchPage/UnpinPage versus thread count, for a single
+ * instance buffer pool and a partitioned one. Each thread fetches pages
+ * uniformly at random from a working set slightly larger than the pool, so
+ * the run mixes hits and misses. --page_table=direct_mapped runs it with
+ * direct-mapped page tables instead of linear probing ones.
+ */
+
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include "benchmark_util.h"
+#include "buffer/buffer_pool_manager.h"
+
+using namespace cmudb;
+
+static double RunWorkload(size_t pool_size, size_t num_instances,
+                          PageTableType page_table_type, int num_pages,
+                          int num_threads, long ops) {
+  remove("bpm_benchmark.db");
+  DiskManager disk_manager("bpm_benchmark.db");
+  BufferPoolManager bpm(pool_size, &disk_manager, nullptr, num_instances,
+                        ReplacerType::LRU, page_table_type);
+
+  // populate the file
+  page_id_t page_id;
+  for (int i = 0; i < num_pages; i++) {
+    Page *page = bpm.NewPage(page_id);
+    if (page == nullptr) {
+      fprintf(stderr, "could not allocate page %d\n", i);
+      return 0;
+    }
+    bpm.UnpinPage(page_id, true);
+  }
+
+  double seconds = RunThreads(num_threads, [&](int tid) {
+    std::mt19937 rng(tid);
+    std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+    for (long i = 0; i < ops; i++) {
+      page_id_t target = dist(rng);
+      Page *page = bpm.FetchPage(target);
+      if (page != nullptr)
+        bpm.UnpinPage(target, false);
+    }
+  });
+
+  remove("bpm_benchmark.db");
+  remove("bpm_benchmark.log");
+  remove("bpm_benchmark.fsm");
+  return num_threads * ops / seconds;
+}
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args(argc, argv);
+  if (args.Help("[--pool_size=N] [--instances=N] [--max_threads=N] "
+                "[--ops=N] [--page_table=linear_probe|direct_mapped]"))
+    return 0;
+
+  size_t pool_size = args.GetInt("pool_size", 1024);
+  size_t instances = args.GetInt("instances", 16);
+  int max_threads = args.GetInt("max_threads", 16);
+  long ops = args.GetInt("ops", 100000);
+  PageTableType page_table_type =
+      args.GetString("page_table", "linear_probe") == "direct_mapped"
+          ? PageTableType::DIRECT_MAPPED
+          : PageTableType::LINEAR_PROBE;
+  // 20% larger than the pool, so roughly one access in six misses
+  int num_pages = pool_size + pool_size / 5;
+
+  printf("%-8s %-12s %-16s\n", "threads", "instances", "ops/sec");
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    for (size_t n : {(size_t)1, instances}) {
+      printf("%-8d %-12zu %-16.0f\n", threads, n,
+             RunWorkload(pool_size, n, page_table_type, num_pages, threads,
+                         ops));
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,168 @@
+/**
+ * frame_arena_benchmark.cpp
+ *
+ * Cost of touching many resident frames with each kind of frame memory
+ * (see frame_arena.h). The pool holds every page, so there is no I/O: the
+ * lookups fetch random pages and read a word at a random offset, the scans
+ * fetch every page in order and read all of it. Data TLB misses are counted
+ * with perf where the kernel lets us, "n/a" otherwise.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "benchmark_util.h"
+#include "buffer/buffer_pool_manager.h"
+
+using namespace cmudb;
+
+// data TLB misses of the calling thread between Start and Stop
+class TLBMissCounter {
+public:
+  TLBMissCounter() : fd_(-1) {
+#ifdef __linux__
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                  (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    fd_ = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+  }
+  ~TLBMissCounter() {
+#ifdef __linux__
+    if (fd_ >= 0)
+      close(fd_);
+#endif
+  }
+
+  void Start() {
+#ifdef __linux__
+    if (fd_ >= 0) {
+      ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  // misses since Start, -1 if they cannot be counted
+  long Stop() {
+    long long misses = -1;
+#ifdef __linux__
+    if (fd_ >= 0) {
+      ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd_, &misses, sizeof(misses)) != sizeof(misses))
+        misses = -1;
+    }
+#endif
+    return misses;
+  }
+
+private:
+  int fd_;
+};
+
+// keeps the reads from being optimized away
+static volatile long sink;
+
+static std::string PerOp(long misses, long ops) {
+  if (misses < 0)
+    return "n/a";
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.3f", (double)misses / ops);
+  return buffer;
+}
+
+static void RunWorkload(size_t pool_size, int page_size, long lookups,
+                        int scans, HugePageMode huge_page_mode) {
+  remove("arena_benchmark.db");
+  DiskManager disk_manager("arena_benchmark.db", page_size);
+  BufferPoolManager bpm(pool_size, &disk_manager, nullptr, 1,
+                        ReplacerType::LRU, PageTableType::LINEAR_PROBE,
+                        huge_page_mode);
+  int num_pages = pool_size;
+  page_id_t page_id;
+  for (int i = 0; i < num_pages; i++) {
+    Page *page = bpm.NewPage(page_id);
+    if (page == nullptr) {
+      fprintf(stderr, "could not allocate page %d\n", i);
+      return;
+    }
+    memset(page->GetData(), i, page_size);
+    bpm.UnpinPage(page_id, true);
+  }
+
+  TLBMissCounter tlb_misses;
+  std::mt19937 rng(0);
+  long sum = 0;
+  tlb_misses.Start();
+  BenchmarkTimer lookup_timer;
+  for (long i = 0; i < lookups; i++) {
+    page_id_t target = rng() % num_pages;
+    Page *page = bpm.FetchPage(target);
+    if (page == nullptr)
+      continue;
+    sum += page->GetData()[rng() % page_size];
+    bpm.UnpinPage(target, false);
+  }
+  double lookup_seconds = lookup_timer.ElapsedSeconds();
+  long lookup_misses = tlb_misses.Stop();
+
+  tlb_misses.Start();
+  BenchmarkTimer scan_timer;
+  for (int scan = 0; scan < scans; scan++) {
+    for (page_id_t target = 0; target < num_pages; target++) {
+      Page *page = bpm.FetchPage(target);
+      if (page == nullptr)
+        continue;
+      const long *data = reinterpret_cast<const long *>(page->GetData());
+      for (size_t j = 0; j < page_size / sizeof(long); j++)
+        sum += data[j];
+      bpm.UnpinPage(target, false);
+    }
+  }
+  double scan_seconds = scan_timer.ElapsedSeconds();
+  long scan_misses = tlb_misses.Stop();
+
+  sink = sum;
+  printf("%-12s %-14.0f %-14s %-14.0f %-14s\n",
+         HugePageModeToString(bpm.GetHugePageMode()).c_str(),
+         lookups / lookup_seconds, PerOp(lookup_misses, lookups).c_str(),
+         (double)scans * num_pages / scan_seconds,
+         PerOp(scan_misses, (long)scans * num_pages).c_str());
+
+  remove("arena_benchmark.db");
+  remove("arena_benchmark.log");
+  remove("arena_benchmark.fsm");
+}
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args(argc, argv);
+  if (args.Help("[--pool_size=N] [--page_size=N] [--lookups=N] [--scans=N]"))
+    return 0;
+
+  size_t pool_size = args.GetInt("pool_size", 16384);
+  int page_size = args.GetInt("page_size", 4096);
+  long lookups = args.GetInt("lookups", 2000000);
+  int scans = args.GetInt("scans", 10);
+
+  printf("%-12s %-14s %-14s %-14s %-14s\n", "memory", "lookups/sec",
+         "tlb miss/op", "scan pages/sec", "tlb miss/page");
+  for (auto huge_page_mode : {HugePageMode::NONE, HugePageMode::TRANSPARENT,
+                              HugePageMode::HUGETLB}) {
+    RunWorkload(pool_size, page_size, lookups, scans, huge_page_mode);
+  }
+  return 0;
+}
@@ -0,0 +1,58 @@
+/**
+ * hot_page_benchmark.cpp
+ *
+ * FetchPage/UnpinPage throughput on resident pages versus thread count. With
+ * --hot_pages=1 every thread hits the same page, like concurrent lookups all
+ * starting at the root of an index; hits take no latch, so the throughput
+ * should grow with the number of threads until the pin count's cache line
+ * saturates.
+ */
+
+#include <cstdio>
+#include <random>
+
+#include "benchmark_util.h"
+#include "buffer/buffer_pool_manager.h"
+
+using namespace cmudb;
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args(argc, argv);
+  if (args.Help("[--hot_pages=N] [--max_threads=N] [--ops=N]"))
+    return 0;
+
+  int hot_pages = args.GetInt("hot_pages", 1);
+  int max_threads = args.GetInt("max_threads", 8);
+  long ops = args.GetInt("ops", 2000000);
+
+  remove("hot_page_benchmark.db");
+  DiskManager disk_manager("hot_page_benchmark.db");
+  BufferPoolManager bpm(hot_pages + 16, &disk_manager);
+  page_id_t page_id;
+  for (int i = 0; i < hot_pages; i++) {
+    if (bpm.NewPage(page_id) == nullptr) {
+      fprintf(stderr, "could not allocate page %d\n", i);
+      return 1;
+    }
+    bpm.UnpinPage(page_id, true);
+  }
+
+  printf("%-8s %-14s %-8s\n", "threads", "Mfetches/sec", "hit%");
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    BufferPoolStatsSnapshot before = bpm.GetStats();
+    double seconds = RunThreads(threads, [&](int tid) {
+      std::mt19937 rng(tid);
+      for (long i = 0; i < ops; i++) {
+        page_id_t target = hot_pages == 1 ? 0 : rng() % hot_pages;
+        if (bpm.FetchPage(target) != nullptr)
+          bpm.UnpinPage(target, false);
+      }
+    });
+    BufferPoolStatsSnapshot delta = bpm.GetStats().Delta(before);
+    printf("%-8d %-14.2f %-8.1f\n", threads, threads * ops / seconds / 1e6,
+           100 * delta.HitRatio());
+  }
+
+  remove("hot_page_benchmark.db");
+  return 0;
+}
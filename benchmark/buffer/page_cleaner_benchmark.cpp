@@ -0,0 +1,92 @@
+/**
+ * page_cleaner_benchmark.cpp
+ *
+ * Update heavy workload with and without the background page cleaner. Each
+ * thread fetches pages uniformly at random from a working set larger than
+ * the pool and dirties a fraction of them, so many victims are dirty. The
+ * run reports throughput and how many dirty page writes were paid by the
+ * worker threads versus by the cleaner.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+#include "benchmark_util.h"
+#include "buffer/buffer_pool_manager.h"
+
+using namespace cmudb;
+
+static void RunWorkload(size_t pool_size, size_t num_instances, int num_pages,
+                        int num_threads, long ops, int update_percent,
+                        size_t clean_target) {
+  remove("cleaner_benchmark.db");
+  DiskManager disk_manager("cleaner_benchmark.db");
+  BufferPoolManager bpm(pool_size, &disk_manager, nullptr, num_instances);
+
+  // populate the file
+  page_id_t page_id;
+  for (int i = 0; i < num_pages; i++) {
+    Page *page = bpm.NewPage(page_id);
+    if (page == nullptr) {
+      fprintf(stderr, "could not allocate page %d\n", i);
+      return;
+    }
+    bpm.UnpinPage(page_id, true);
+  }
+  size_t foreground_before = bpm.GetNumForegroundWrites();
+
+  if (clean_target > 0)
+    bpm.RunPageCleanerThread(clean_target);
+  double seconds = RunThreads(num_threads, [&](int tid) {
+    std::mt19937 rng(tid);
+    std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+    for (long i = 0; i < ops; i++) {
+      page_id_t target = dist(rng);
+      Page *page = bpm.FetchPage(target);
+      if (page == nullptr)
+        continue;
+      bool update = (int)(rng() % 100) < update_percent;
+      if (update) {
+        page->WLatch();
+        memcpy(page->GetData(), &i, sizeof(i));
+        page->WUnlatch();
+      }
+      bpm.UnpinPage(target, update);
+    }
+  });
+  bpm.StopPageCleanerThread();
+
+  printf("%-8d %-8zu %-16.0f %-14zu %-14zu\n", num_threads, clean_target,
+         num_threads * ops / seconds,
+         bpm.GetNumForegroundWrites() - foreground_before,
+         bpm.GetNumBackgroundWrites());
+
+  remove("cleaner_benchmark.db");
+  remove("cleaner_benchmark.log");
+  remove("cleaner_benchmark.fsm");
+}
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args(argc, argv);
+  if (args.Help("[--pool_size=N] [--instances=N] [--threads=N] [--ops=N] "
+                "[--update_percent=N] [--clean_target=N]"))
+    return 0;
+
+  size_t pool_size = args.GetInt("pool_size", 1024);
+  size_t instances = args.GetInt("instances", 8);
+  int threads = args.GetInt("threads", 4);
+  long ops = args.GetInt("ops", 50000);
+  int update_percent = args.GetInt("update_percent", 50);
+  // per instance
+  size_t clean_target = args.GetInt("clean_target", 16);
+  int num_pages = pool_size * 2;
+
+  printf("%-8s %-8s %-16s %-14s %-14s\n", "threads", "target", "ops/sec",
+         "fg writes", "bg writes");
+  for (size_t target : {(size_t)0, clean_target}) {
+    RunWorkload(pool_size, instances, num_pages, threads, ops, update_percent,
+                target);
+  }
+  return 0;
+}
@@ -0,0 +1,64 @@
+/**
+ * replacer_benchmark.cpp
+ *
+ * Cost of replacer bookkeeping as the buffer pool drives it: every fetch of
+ * a resident frame is an Erase (pin) followed by an Insert (unpin), and
+ * every miss is a Victim followed by an Insert. Reports millions of
+ * operations per second for each policy.
+ */
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "replacer_benchmark_util.h"
+
+using namespace cmudb;
+
+static double RunReplacer(ReplacerType replacer_type, int num_frames,
+                          long ops, int miss_percent) {
+  Replacer<int> *replacer = NewIntReplacer(replacer_type, num_frames);
+  for (int frame = 0; frame < num_frames; frame++) {
+    replacer->Insert(frame);
+  }
+
+  std::mt19937 rng(0);
+  int victim;
+  BenchmarkTimer timer;
+  for (long i = 0; i < ops; i++) {
+    if ((long)(rng() % 100) < miss_percent) {
+      replacer->Victim(victim);
+      replacer->Insert(victim);
+    } else {
+      int frame = rng() % num_frames;
+      replacer->Erase(frame);
+      replacer->Insert(frame);
+    }
+  }
+  double seconds = timer.ElapsedSeconds();
+  delete replacer;
+  return ops / seconds / 1e6;
+}
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args(argc, argv);
+  if (args.Help("[--frames=N] [--ops=N]"))
+    return 0;
+
+  int num_frames = args.GetInt("frames", 4096);
+  long ops = args.GetInt("ops", 5000000);
+
+  printf("%-8s %-8s %-12s\n", "policy", "miss%", "Mops/sec");
+  for (int miss_percent : {0, 10, 50}) {
+    for (auto replacer_type :
+         {ReplacerType::LRU, ReplacerType::CLOCK, ReplacerType::LRU_K,
+          ReplacerType::ARC}) {
+      printf("%-8s %-8d %-12.2f\n",
+             ReplacerTypeToString(replacer_type).c_str(), miss_percent,
+             RunReplacer(replacer_type, num_frames, ops, miss_percent));
+    }
+  }
+  return 0;
+}
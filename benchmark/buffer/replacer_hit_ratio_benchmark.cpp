@@ -0,0 +1,149 @@
+/**
+ * replacer_hit_ratio_benchmark.cpp
+ *
+ * Hit ratio of each replacement policy under a mix of B+ tree style point
+ * lookups and periodic full table scans. The buffer pool is simulated on
+ * top of the Replacer interface (no disk I/O), driving it like
+ * BufferPoolManager does: Erase on pin, Insert on unpin, Victim on a miss
+ * with no free frame. The replacers are fed page ids instead of frames,
+ * which is what ARC keys its ghost lists on anyway.
+ *
+ * Each point lookup touches the index root, one of the internal pages and a
+ * leaf chosen with a skewed distribution. Every --lookups lookups a scan
+ * reads --table_pages heap pages once each, which is much more than the
+ * pool can hold.
+ *
+ * Every policy runs twice: once on its own, and once with the pages tagged
+ * with retention priorities (root and internal pages INDEX, leaves LEAF,
+ * scanned pages SCAN) on top of a PriorityReplacer, as BufferPoolManager
+ * does.
+ */
+
+#include <cstdio>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "buffer/priority_replacer.h"
+#include "common/config.h"
+#include "replacer_benchmark_util.h"
+
+using namespace cmudb;
+
+class PoolSimulator {
+public:
+  PoolSimulator(ReplacerType replacer_type, size_t pool_size, bool hints)
+      : pool_size_(pool_size), hits_(0), misses_(0) {
+    if (hints) {
+      std::vector<Replacer<int> *> levels;
+      for (int i = 0; i < static_cast<int>(PagePriority::NUM_PRIORITIES); i++)
+        levels.push_back(NewIntReplacer(replacer_type, pool_size, true));
+      replacer_ = new PriorityReplacer<int>(levels);
+    } else {
+      replacer_ = NewIntReplacer(replacer_type, pool_size);
+    }
+  }
+
+  ~PoolSimulator() { delete replacer_; }
+
+  // fetch and unpin page_id with priority, return true on a hit
+  bool Access(page_id_t page_id, PagePriority priority) {
+    if (resident_.count(page_id) != 0) {
+      replacer_->Erase(page_id);
+      replacer_->Insert(page_id, priority);
+      hits_++;
+      return true;
+    }
+
+    misses_++;
+    if (resident_.size() == pool_size_) {
+      int victim;
+      replacer_->Victim(victim);
+      resident_.erase(victim);
+    }
+    resident_.insert(page_id);
+    replacer_->Insert(page_id, priority);
+    return false;
+  }
+
+  double HitRatio() const {
+    return hits_ + misses_ == 0 ? 0 : (double)hits_ / (hits_ + misses_);
+  }
+
+private:
+  size_t pool_size_;
+  std::unordered_set<page_id_t> resident_;
+  Replacer<int> *replacer_;
+  long hits_;
+  long misses_;
+};
+
+// page id layout: root, internal pages, leaves, then the heap
+struct Workload {
+  int internal_pages;
+  int leaf_pages;
+  int table_pages;
+  long lookups;
+  int rounds;
+};
+
+// run the lookups and scans, return the hit ratio of the lookups
+static double RunWorkload(PoolSimulator &pool, const Workload &workload) {
+  const page_id_t root_id = 0;
+  const page_id_t first_internal = 1;
+  const page_id_t first_leaf = first_internal + workload.internal_pages;
+  const page_id_t first_heap = first_leaf + workload.leaf_pages;
+
+  std::mt19937 rng(0);
+  // roughly 80% of the lookups go to 20% of the leaves
+  std::geometric_distribution<int> leaf_dist(8.0 / workload.leaf_pages);
+  long lookup_hits = 0, lookup_accesses = 0;
+
+  for (int round = 0; round < workload.rounds; round++) {
+    for (long i = 0; i < workload.lookups; i++) {
+      lookup_hits += pool.Access(root_id, PagePriority::INDEX);
+      lookup_hits += pool.Access(
+          first_internal + (int)(rng() % workload.internal_pages),
+          PagePriority::INDEX);
+      lookup_hits +=
+          pool.Access(first_leaf + leaf_dist(rng) % workload.leaf_pages,
+                      PagePriority::LEAF);
+      lookup_accesses += 3;
+    }
+    for (int i = 0; i < workload.table_pages; i++) {
+      pool.Access(first_heap + i, PagePriority::SCAN);
+    }
+  }
+  return (double)lookup_hits / lookup_accesses;
+}
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args(argc, argv);
+  if (args.Help("[--pool_size=N] [--leaf_pages=N] [--table_pages=N] "
+                "[--lookups=N] [--rounds=N]"))
+    return 0;
+
+  size_t pool_size = args.GetInt("pool_size", 256);
+  Workload workload;
+  workload.internal_pages = 16;
+  workload.leaf_pages = args.GetInt("leaf_pages", 400);
+  workload.table_pages = args.GetInt("table_pages", 4096);
+  workload.lookups = args.GetInt("lookups", 5000);
+  workload.rounds = args.GetInt("rounds", 20);
+
+  printf("%-8s %-6s %-14s %-14s\n", "policy", "hints", "lookup hit%",
+         "overall hit%");
+  for (auto replacer_type :
+       {ReplacerType::LRU, ReplacerType::CLOCK, ReplacerType::LRU_K,
+        ReplacerType::ARC}) {
+    for (bool hints : {false, true}) {
+      PoolSimulator pool(replacer_type, pool_size, hints);
+      double lookup_hit_ratio = RunWorkload(pool, workload);
+      printf("%-8s %-6s %-14.2f %-14.2f\n",
+             ReplacerTypeToString(replacer_type).c_str(), hints ? "yes" : "no",
+             100.0 * lookup_hit_ratio, 100.0 * pool.HitRatio());
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,102 @@
+/**
+ * scan_resistance_benchmark.cpp
+ *
+ * Point lookups running concurrently with a full scan. The lookup threads
+ * fetch pages of a hot set that fits in the buffer pool, while one thread
+ * scans a table several times larger than the pool, either with normal
+ * fetches or as a BULK_READ. With normal fetches the scan keeps evicting the
+ * hot set and the lookups keep missing; a bulk read only cycles through the
+ * ring, so the lookups run at hit speed.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <random>
+
+#include "benchmark_util.h"
+#include "buffer/buffer_pool_manager.h"
+
+using namespace cmudb;
+
+static void RunWorkload(size_t pool_size, int hot_pages, int table_pages,
+                        int lookup_threads, int scans,
+                        AccessStrategy strategy) {
+  remove("scan_benchmark.db");
+  DiskManager disk_manager("scan_benchmark.db");
+  BufferPoolManager bpm(pool_size, &disk_manager);
+
+  // page ids: the hot set, then the table
+  page_id_t page_id;
+  for (int i = 0; i < hot_pages + table_pages; i++) {
+    Page *page = bpm.NewPage(page_id);
+    if (page == nullptr) {
+      fprintf(stderr, "could not allocate page %d\n", i);
+      return;
+    }
+    bpm.UnpinPage(page_id, true);
+    bpm.FlushPage(page_id);
+  }
+  // warm the hot set up
+  for (int i = 0; i < hot_pages; i++) {
+    if (bpm.FetchPage(i) != nullptr)
+      bpm.UnpinPage(i, false);
+  }
+
+  std::atomic<bool> scan_done(false);
+  std::atomic<long> lookups(0);
+  double scan_seconds = 0;
+  double seconds = RunThreads(lookup_threads + 1, [&](int tid) {
+    if (tid == 0) {
+      BenchmarkTimer timer;
+      for (int scan = 0; scan < scans; scan++) {
+        for (page_id_t target = hot_pages; target < hot_pages + table_pages;
+             target++) {
+          if (bpm.FetchPage(target, strategy) != nullptr)
+            bpm.UnpinPage(target, false);
+        }
+      }
+      scan_seconds = timer.ElapsedSeconds();
+      scan_done = true;
+      return;
+    }
+
+    std::mt19937 rng(tid);
+    std::uniform_int_distribution<page_id_t> dist(0, hot_pages - 1);
+    long ops = 0;
+    while (!scan_done) {
+      page_id_t target = dist(rng);
+      if (bpm.FetchPage(target) != nullptr)
+        bpm.UnpinPage(target, false);
+      ops++;
+    }
+    lookups += ops;
+  });
+
+  printf("%-10s %-16.0f %-16.0f\n",
+         strategy == AccessStrategy::BULK_READ ? "bulk_read" : "normal",
+         scans * table_pages / scan_seconds, lookups / seconds);
+
+  remove("scan_benchmark.db");
+  remove("scan_benchmark.log");
+  remove("scan_benchmark.fsm");
+}
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args(argc, argv);
+  if (args.Help("[--pool_size=N] [--hot_pages=N] [--table_pages=N] "
+                "[--threads=N] [--scans=N]"))
+    return 0;
+
+  size_t pool_size = args.GetInt("pool_size", 1024);
+  int hot_pages = args.GetInt("hot_pages", 512);
+  int table_pages = args.GetInt("table_pages", 8192);
+  int lookup_threads = args.GetInt("threads", 2);
+  int scans = args.GetInt("scans", 3);
+
+  printf("%-10s %-16s %-16s\n", "scan", "scan pages/sec", "lookups/sec");
+  for (auto strategy : {AccessStrategy::NORMAL, AccessStrategy::BULK_READ}) {
+    RunWorkload(pool_size, hot_pages, table_pages, lookup_threads, scans,
+                strategy);
+  }
+  return 0;
+}
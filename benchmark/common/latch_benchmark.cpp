@@ -0,0 +1,75 @@
+/**
+ * latch_benchmark.cpp
+ *
+ * RWMutex against SharedLatch under contention. Every thread repeatedly
+ * latches one of --latches latches, shared except for --write_percent of
+ * the acquisitions, and touches the data it protects, the way index
+ * crabbing latches and releases pages. With --latches=1 all threads fight
+ * over the same latch, like the root of an index.
+ */
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "common/rwmutex.h"
+#include "common/shared_latch.h"
+
+using namespace cmudb;
+
+template <typename Latch> struct Protected {
+  Latch latch;
+  long value = 0;
+};
+
+template <typename Latch>
+static double RunLatches(int num_latches, int num_threads, long ops,
+                         int write_percent) {
+  std::vector<Protected<Latch>> latches(num_latches);
+  double seconds = RunThreads(num_threads, [&](int tid) {
+    std::mt19937 rng(tid);
+    long sum = 0;
+    for (long i = 0; i < ops; i++) {
+      uint32_t random = rng();
+      Protected<Latch> &target = latches[random % num_latches];
+      if ((random >> 16) % 100 < static_cast<uint32_t>(write_percent)) {
+        target.latch.WLock();
+        target.value++;
+        target.latch.WUnlock();
+      } else {
+        target.latch.RLock();
+        sum += target.value;
+        target.latch.RUnlock();
+      }
+    }
+    // keep the reads from being optimized away
+    if (sum < 0)
+      printf("%ld\n", sum);
+  });
+  return num_threads * ops / seconds / 1e6;
+}
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args(argc, argv);
+  if (args.Help("[--latches=N] [--max_threads=N] [--ops=N] "
+                "[--write_percent=N]"))
+    return 0;
+
+  int num_latches = args.GetInt("latches", 1);
+  int max_threads = args.GetInt("max_threads", 8);
+  long ops = args.GetInt("ops", 1000000);
+  int write_percent = args.GetInt("write_percent", 5);
+
+  printf("sizeof(RWMutex) = %zu, sizeof(SharedLatch) = %zu\n",
+         sizeof(RWMutex), sizeof(SharedLatch));
+  printf("%-12s %-8s %-12s\n", "latch", "threads", "Mops/sec");
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    printf("%-12s %-8d %-12.2f\n", "RWMutex", threads,
+           RunLatches<RWMutex>(num_latches, threads, ops, write_percent));
+    printf("%-12s %-8d %-12.2f\n", "SharedLatch", threads,
+           RunLatches<SharedLatch>(num_latches, threads, ops, write_percent));
+  }
+  return 0;
+}
@@ -0,0 +1,85 @@
+/**
+ * async_io_benchmark.cpp
+ *
+ * Random page read throughput of the DiskManager asynchronous I/O backends
+ * versus queue depth. A single thread submits batches of --depth reads of
+ * pages chosen uniformly at random and waits for each batch to complete.
+ * As with disk_manager_benchmark, a file that fits in memory measures the
+ * submission path out of the page cache; make it larger than memory (or
+ * drop the caches) to measure the device.
+ */
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "disk/disk_manager.h"
+
+using namespace cmudb;
+
+static void RunBackend(AsyncIOType async_io_type, int file_pages,
+                       int page_size, int max_depth, long reads) {
+  DiskManager disk_manager("async_benchmark.db", page_size);
+  disk_manager.SetAsyncIOType(async_io_type);
+  // falls back to the thread pool where io_uring is not available
+  if (disk_manager.GetAsyncIOType() != async_io_type) {
+    printf("%-12s not available\n",
+           AsyncIOTypeToString(async_io_type).c_str());
+    return;
+  }
+
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<page_id_t> dist(0, file_pages - 1);
+  for (int depth = 1; depth <= max_depth; depth *= 2) {
+    std::vector<char> buffers(static_cast<size_t>(depth) * page_size);
+    std::vector<PageIORequest> batch(depth);
+    long done = 0;
+    BenchmarkTimer timer;
+    while (done < reads) {
+      for (int i = 0; i < depth; i++) {
+        batch[i] = {false, dist(rng), &buffers[i * page_size], 1};
+      }
+      for (auto &future : disk_manager.SubmitPageIO(batch)) {
+        future.wait();
+      }
+      done += depth;
+    }
+    printf("%-12s %-8d %-16.0f\n",
+           AsyncIOTypeToString(async_io_type).c_str(), depth,
+           done / timer.ElapsedSeconds());
+  }
+}
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args(argc, argv);
+  if (args.Help("[--file_pages=N] [--page_size=N] [--max_depth=N] "
+                "[--reads=N]"))
+    return 0;
+
+  int file_pages = args.GetInt("file_pages", 16384);
+  int page_size = args.GetInt("page_size", 4096);
+  int max_depth = args.GetInt("max_depth", ASYNC_IO_QUEUE_DEPTH);
+  long reads = args.GetInt("reads", 200000);
+
+  remove("async_benchmark.db");
+  {
+    DiskManager disk_manager("async_benchmark.db", page_size);
+    page_size = disk_manager.GetPageSize();
+    std::vector<char> data(page_size, 'x');
+    for (int i = 0; i < file_pages; i++) {
+      disk_manager.WritePage(i, data.data());
+    }
+  }
+
+  printf("%-12s %-8s %-16s\n", "backend", "depth", "reads/sec");
+  for (auto async_io_type :
+       {AsyncIOType::IO_URING, AsyncIOType::THREAD_POOL}) {
+    RunBackend(async_io_type, file_pages, page_size, max_depth, reads);
+  }
+
+  remove("async_benchmark.db");
+  remove("async_benchmark.log");
+  remove("async_benchmark.fsm");
+  return 0;
+}
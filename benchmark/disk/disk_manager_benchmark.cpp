@@ -0,0 +1,56 @@
+/**
+ * disk_manager_benchmark.cpp
+ *
+ * Random page read IOPS of DiskManager versus thread count. Each thread
+ * reads pages chosen uniformly at random from a file of --file_pages pages.
+ * A file that fits in memory measures the system call path out of the page
+ * cache; make it larger than memory (or drop the caches) to measure the
+ * device.
+ */
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "disk/disk_manager.h"
+
+using namespace cmudb;
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args(argc, argv);
+  if (args.Help("[--file_pages=N] [--page_size=N] [--max_threads=N] "
+                "[--reads=N]"))
+    return 0;
+
+  int file_pages = args.GetInt("file_pages", 16384);
+  int page_size = args.GetInt("page_size", 4096);
+  int max_threads = args.GetInt("max_threads", 32);
+  long reads = args.GetInt("reads", 200000);
+
+  remove("disk_benchmark.db");
+  DiskManager disk_manager("disk_benchmark.db", page_size);
+  page_size = disk_manager.GetPageSize();
+  std::vector<char> data(page_size, 'x');
+  for (int i = 0; i < file_pages; i++) {
+    disk_manager.WritePage(i, data.data());
+  }
+
+  printf("%-8s %-16s\n", "threads", "reads/sec");
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    double seconds = RunThreads(threads, [&](int tid) {
+      std::mt19937 rng(tid);
+      std::uniform_int_distribution<page_id_t> dist(0, file_pages - 1);
+      std::vector<char> buffer(page_size);
+      for (long i = 0; i < reads; i++) {
+        disk_manager.ReadPage(dist(rng), buffer.data());
+      }
+    });
+    printf("%-8d %-16.0f\n", threads, threads * reads / seconds);
+  }
+
+  remove("disk_benchmark.db");
+  remove("disk_benchmark.log");
+  remove("disk_benchmark.fsm");
+  return 0;
+}
@@ -0,0 +1,110 @@
+/**
+ * mmap_read_benchmark.cpp
+ *
+ * Page read latency of the DiskManager read modes: PREAD (a system call per
+ * page), MMAP (a memcpy out of the mapped file) and the zero-copy page view
+ * of MMAP. The scan reads every page of a --file_pages file in order, the
+ * lookups read pages chosen uniformly at random; each is reported as the
+ * mean, and the lookups also as the median and 99th percentile, of single
+ * reads. As with disk_manager_benchmark, a file that fits in memory
+ * measures the path out of the page cache.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "disk/disk_manager.h"
+
+using namespace cmudb;
+
+// keeps the reads from being optimized away
+static volatile long sink;
+
+static void RunMode(ReadMode read_mode, bool zero_copy, int file_pages,
+                    int page_size, int scans, long lookups) {
+  DiskManager disk_manager("mmap_benchmark.db", page_size);
+  disk_manager.SetReadMode(read_mode);
+  std::string name = zero_copy ? "MMAP_VIEW" : ReadModeToString(read_mode);
+  if (disk_manager.GetReadMode() != read_mode) {
+    printf("%-10s not available\n", name.c_str());
+    return;
+  }
+
+  std::vector<char> buffer(page_size);
+  long sum = 0;
+  auto read_page = [&](page_id_t page_id) {
+    if (zero_copy) {
+      sum += disk_manager.GetPageView(page_id)[page_id % page_size];
+    } else {
+      disk_manager.ReadPage(page_id, buffer.data());
+      sum += buffer[page_id % page_size];
+    }
+  };
+
+  BenchmarkTimer scan_timer;
+  for (int scan = 0; scan < scans; scan++) {
+    for (page_id_t page_id = 0; page_id < file_pages; page_id++) {
+      read_page(page_id);
+    }
+  }
+  double scan_ns = scan_timer.ElapsedSeconds() * 1e9 / scans / file_pages;
+
+  std::mt19937 rng(0);
+  std::vector<long> latencies(lookups);
+  for (long i = 0; i < lookups; i++) {
+    page_id_t page_id = rng() % file_pages;
+    auto start = std::chrono::steady_clock::now();
+    read_page(page_id);
+    latencies[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  }
+  double mean = 0;
+  for (long latency : latencies) {
+    mean += latency;
+  }
+  mean /= lookups;
+  std::sort(latencies.begin(), latencies.end());
+
+  sink = sum;
+  printf("%-10s %-14.0f %-14.0f %-14ld %-14ld\n", name.c_str(), scan_ns, mean,
+         latencies[lookups / 2], latencies[lookups * 99 / 100]);
+}
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args(argc, argv);
+  if (args.Help("[--file_pages=N] [--page_size=N] [--scans=N] "
+                "[--lookups=N]"))
+    return 0;
+
+  int file_pages = args.GetInt("file_pages", 16384);
+  int page_size = args.GetInt("page_size", 4096);
+  int scans = args.GetInt("scans", 10);
+  long lookups = args.GetInt("lookups", 200000);
+
+  remove("mmap_benchmark.db");
+  {
+    DiskManager disk_manager("mmap_benchmark.db", page_size);
+    page_size = disk_manager.GetPageSize();
+    std::vector<char> data(page_size, 'x');
+    for (int i = 0; i < file_pages; i++) {
+      disk_manager.WritePage(i, data.data());
+    }
+  }
+
+  printf("%-10s %-14s %-14s %-14s %-14s\n", "read", "scan ns/page",
+         "lookup mean", "lookup p50", "lookup p99");
+  RunMode(ReadMode::PREAD, false, file_pages, page_size, scans, lookups);
+  RunMode(ReadMode::MMAP, false, file_pages, page_size, scans, lookups);
+  RunMode(ReadMode::MMAP, true, file_pages, page_size, scans, lookups);
+
+  remove("mmap_benchmark.db");
+  remove("mmap_benchmark.log");
+  remove("mmap_benchmark.fsm");
+  return 0;
+}
@@ -0,0 +1,79 @@
+/**
+ * page_churn_benchmark.cpp
+ *
+ * Growth of the db file under page churn. A fixed number of live pages is
+ * kept while every step deletes a random one and creates a new page, as
+ * tables and indexes do when they drop and split pages. Since deleted pages
+ * are reused the file should stop growing at about the live set; the run
+ * reports the file size and the pages waiting in the free space map after
+ * every round of --live_pages steps.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "buffer/buffer_pool_manager.h"
+
+using namespace cmudb;
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args(argc, argv);
+  if (args.Help("[--live_pages=N] [--pool_size=N] [--rounds=N]"))
+    return 0;
+
+  int live_pages = args.GetInt("live_pages", 10000);
+  size_t pool_size = args.GetInt("pool_size", 1000);
+  int rounds = args.GetInt("rounds", 10);
+
+  remove("churn_benchmark.db");
+  DiskManager disk_manager("churn_benchmark.db");
+  BufferPoolManager bpm(pool_size, &disk_manager);
+
+  std::vector<page_id_t> live;
+  page_id_t page_id;
+  for (int i = 0; i < live_pages; i++) {
+    Page *page = bpm.NewPage(page_id);
+    if (page == nullptr) {
+      fprintf(stderr, "could not allocate page %d\n", i);
+      return 1;
+    }
+    memcpy(page->GetData(), &i, sizeof(i));
+    bpm.UnpinPage(page_id, true);
+    live.push_back(page_id);
+  }
+  bpm.FlushAllPages();
+
+  std::mt19937 rng(0);
+  printf("%-8s %-12s %-12s %-12s %-14s\n", "round", "live pages",
+         "file pages", "free pages", "steps/sec");
+  printf("%-8d %-12d %-12d %-12zu %-14s\n", 0, live_pages,
+         disk_manager.GetNumPages(), disk_manager.GetNumFreePages(), "-");
+  for (int round = 1; round <= rounds; round++) {
+    BenchmarkTimer timer;
+    for (int i = 0; i < live_pages; i++) {
+      size_t victim = rng() % live.size();
+      bpm.DeletePage(live[victim]);
+      Page *page = bpm.NewPage(page_id);
+      if (page == nullptr) {
+        fprintf(stderr, "could not allocate a page\n");
+        return 1;
+      }
+      memcpy(page->GetData(), &i, sizeof(i));
+      bpm.UnpinPage(page_id, true);
+      live[victim] = page_id;
+    }
+    double seconds = timer.ElapsedSeconds();
+    bpm.FlushAllPages();
+    printf("%-8d %-12d %-12d %-12zu %-14.0f\n", round, live_pages,
+           disk_manager.GetNumPages(), disk_manager.GetNumFreePages(),
+           live_pages / seconds);
+  }
+
+  remove("churn_benchmark.db");
+  remove("churn_benchmark.log");
+  remove("churn_benchmark.fsm");
+  return 0;
+}
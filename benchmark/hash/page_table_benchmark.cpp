@@ -0,0 +1,88 @@
+/**
+ * page_table_benchmark.cpp
+ *
+ * Lookup throughput of the page table implementations versus thread count.
+ * Each table is filled with pool_size page ids, as the page table of a full
+ * buffer pool would be, and every thread looks up random ids of which
+ * --miss_percent are not resident. The direct-mapped table is filled the
+ * way the page table of instance 0 out of --instances would be, ids stepping
+ * by the number of instances.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include "benchmark_util.h"
+#include "hash/direct_mapped_page_table.h"
+#include "hash/extendible_hash.h"
+#include "hash/linear_probe_hash_table.h"
+#include "page/page.h"
+
+using namespace cmudb;
+
+static double RunLookups(HashTable<page_id_t, Page *> *table, int pool_size,
+                         int stride, int num_threads, long ops,
+                         int miss_percent, double &hit_percent) {
+  Page *page = reinterpret_cast<Page *>(0x1000);
+  for (int i = 0; i < pool_size; i++) {
+    table->Insert(i * stride, page);
+  }
+  // look up ids in [0, range) so that miss_percent of them are absent
+  page_id_t range = pool_size * 100 / (100 - miss_percent);
+
+  std::atomic<long> hits(0);
+  double seconds = RunThreads(num_threads, [&](int tid) {
+    std::mt19937 rng(tid);
+    std::uniform_int_distribution<page_id_t> dist(0, range - 1);
+    Page *result;
+    long found = 0;
+    for (long i = 0; i < ops; i++) {
+      found += table->Find(dist(rng) * stride, result);
+    }
+    hits += found;
+  });
+  hit_percent = 100.0 * hits / (num_threads * ops);
+  return num_threads * ops / seconds / 1e6;
+}
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args(argc, argv);
+  if (args.Help("[--pool_size=N] [--max_threads=N] [--ops=N] "
+                "[--miss_percent=N] [--instances=N]"))
+    return 0;
+
+  int pool_size = args.GetInt("pool_size", 4096);
+  int max_threads = args.GetInt("max_threads", 8);
+  long ops = args.GetInt("ops", 2000000);
+  int miss_percent = args.GetInt("miss_percent", 10);
+  if (miss_percent < 0 || miss_percent > 99)
+    miss_percent = 10;
+  int instances = args.GetInt("instances", 16);
+
+  printf("%-16s %-8s %-14s %-8s\n", "table", "threads", "Mlookups/sec",
+         "hit%");
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    for (std::string name :
+         {"extendible", "linear_probe", "direct_mapped"}) {
+      HashTable<page_id_t, Page *> *table;
+      int stride = 1;
+      if (name == "extendible") {
+        table = new ExtendibleHash<page_id_t, Page *>(BUCKET_SIZE);
+      } else if (name == "linear_probe") {
+        table = new LinearProbeHashTable<page_id_t, Page *>(pool_size);
+      } else {
+        table = new DirectMappedPageTable<Page *>(instances);
+        stride = instances;
+      }
+      double hit_percent;
+      double throughput = RunLookups(table, pool_size, stride, threads, ops,
+                                     miss_percent, hit_percent);
+      printf("%-16s %-8d %-14.2f %-8.1f\n", name.c_str(), threads,
+             throughput, hit_percent);
+      delete table;
+    }
+  }
+  return 0;
+}
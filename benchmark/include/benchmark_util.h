@@ -0,0 +1,91 @@
+/**
+ * benchmark_util.h
+ *
+ * Small helpers shared by the benchmark binaries: "--name=value" argument
+ * parsing, a wall clock timer and a helper that runs a body on N threads.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cmudb {
+
+class BenchmarkArgs {
+public:
+  BenchmarkArgs(int argc, char **argv) : argc_(argc), argv_(argv) {}
+
+  // returns true if "--help" was given, after printing usage
+  bool Help(const char *usage) const {
+    for (int i = 1; i < argc_; i++) {
+      if (strcmp(argv_[i], "--help") == 0) {
+        printf("usage: %s %s\n", argv_[0], usage);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // value of "--name=value", or def if not given
+  long GetInt(const char *name, long def) const {
+    const char *value = Find(name);
+    return value == nullptr ? def : strtol(value, nullptr, 10);
+  }
+
+  std::string GetString(const char *name, const std::string &def) const {
+    const char *value = Find(name);
+    return value == nullptr ? def : std::string(value);
+  }
+
+private:
+  const char *Find(const char *name) const {
+    size_t len = strlen(name);
+    for (int i = 1; i < argc_; i++) {
+      const char *arg = argv_[i];
+      if (strncmp(arg, "--", 2) == 0 && strncmp(arg + 2, name, len) == 0 &&
+          arg[2 + len] == '=')
+        return arg + 3 + len;
+    }
+    return nullptr;
+  }
+
+  int argc_;
+  char **argv_;
+};
+
+class BenchmarkTimer {
+public:
+  BenchmarkTimer() : start_(std::chrono::steady_clock::now()) {}
+
+  double ElapsedSeconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start_)
+        .count();
+  }
+
+private:
+  std::chrono::steady_clock::time_point start_;
+};
+
+// run body(thread_id) on num_threads threads, return wall clock seconds
+inline double RunThreads(int num_threads,
+                         const std::function<void(int)> &body) {
+  std::vector<std::thread> threads;
+  BenchmarkTimer timer;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.push_back(std::thread(body, tid));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return timer.ElapsedSeconds();
+}
+
+} // namespace cmudb
@@ -0,0 +1,33 @@
+/**
+ * replacer_benchmark_util.h
+ *
+ * Replacers over plain integers (page ids or frame ids) for the replacer
+ * benchmarks, which drive the policies without a real buffer pool.
+ */
+
+#pragma once
+
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+
+namespace cmudb {
+
+// shared: one of several replacers over the same frames, see ARCReplacer
+inline Replacer<int> *NewIntReplacer(ReplacerType replacer_type,
+                                     size_t capacity, bool shared = false) {
+  switch (replacer_type) {
+  case ReplacerType::CLOCK:
+    return new ClockReplacer<int>;
+  case ReplacerType::LRU_K:
+    return new LRUKReplacer<int>(LRUK_REPLACER_K, LRUK_CORRELATED_PERIOD);
+  case ReplacerType::ARC:
+    return new ARCReplacer<int>(capacity, shared);
+  case ReplacerType::LRU:
+  default:
+    return new LRUReplacer<int>;
+  }
+}
+
+} // namespace cmudb
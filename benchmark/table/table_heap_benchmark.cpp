@@ -0,0 +1,95 @@
+/**
+ * table_heap_benchmark.cpp
+ *
+ * Effect of the page size on table heap access. For every page size the
+ * same tuples are loaded into a fresh database whose buffer pool has the
+ * same number of bytes (--pool_kb), then the run measures a full sequential
+ * scan and random point lookups by RID, the access pattern of an index
+ * probe. Larger pages mean fewer, larger I/Os for the scan and fewer frames
+ * (so a lower hit ratio) for the lookups.
+ */
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction.h"
+#include "logging/log_manager.h"
+#include "table/table_heap.h"
+
+using namespace cmudb;
+
+static void RunWorkload(int page_size, int pool_kb, int num_tuples,
+                        long lookups) {
+  remove("table_benchmark.db");
+  DiskManager disk_manager("table_benchmark.db", page_size);
+  int pool_size = (long)pool_kb * 1024 / disk_manager.GetPageSize();
+  BufferPoolManager bpm(pool_size, &disk_manager);
+  LockManager lock_manager(true);
+  LogManager log_manager(&disk_manager);
+  Transaction txn(0);
+  TableHeap table(&bpm, &lock_manager, &log_manager, &txn);
+
+  // ~100 byte tuples
+  std::vector<Column> columns = {Column(TypeId::INTEGER, 4, "id"),
+                                 Column(TypeId::BIGINT, 8, "value"),
+                                 Column(TypeId::VARCHAR, 80, "payload")};
+  Schema schema(columns);
+  std::vector<RID> rids;
+  RID rid;
+  for (int i = 0; i < num_tuples; i++) {
+    std::vector<Value> values = {Value(TypeId::INTEGER, (int32_t)i),
+                                 Value(TypeId::BIGINT, (int64_t)i * 7),
+                                 Value(TypeId::VARCHAR, std::string(80, 'x'))};
+    Tuple tuple(values, &schema);
+    if (!table.InsertTuple(tuple, rid, &txn)) {
+      fprintf(stderr, "could not insert tuple %d\n", i);
+      return;
+    }
+    rids.push_back(rid);
+  }
+
+  BenchmarkTimer timer;
+  long scanned = 0;
+  for (auto itr = table.begin(&txn); itr != table.end(); ++itr) {
+    scanned++;
+  }
+  double scan_seconds = timer.ElapsedSeconds();
+
+  std::mt19937 rng(0);
+  Tuple tuple;
+  timer = BenchmarkTimer();
+  for (long i = 0; i < lookups; i++) {
+    table.GetTuple(rids[rng() % rids.size()], tuple, &txn);
+  }
+  double lookup_seconds = timer.ElapsedSeconds();
+
+  printf("%-10d %-8d %-16.2f %-16.0f\n", disk_manager.GetPageSize(),
+         pool_size, scanned / scan_seconds / 1e6, lookups / lookup_seconds);
+
+  remove("table_benchmark.db");
+  remove("table_benchmark.log");
+  remove("table_benchmark.fsm");
+}
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args(argc, argv);
+  if (args.Help("[--pool_kb=N] [--tuples=N] [--lookups=N]"))
+    return 0;
+
+  int pool_kb = args.GetInt("pool_kb", 256);
+  // inserts walk the page chain from the first page, keep the table small
+  int num_tuples = args.GetInt("tuples", 10000);
+  long lookups = args.GetInt("lookups", 200000);
+
+  printf("%-10s %-8s %-16s %-16s\n", "page_size", "frames",
+         "scan Mtuples/s", "lookups/s");
+  for (int page_size : {512, 4096, 8192, 16384}) {
+    RunWorkload(page_size, pool_kb, num_tuples, lookups);
+  }
+  return 0;
+}
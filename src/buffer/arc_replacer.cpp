@@ -0,0 +1,218 @@
+/**
+ * ARC implementation
+ */
+#include <algorithm>
+
+#include "buffer/arc_replacer.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+/*
+ * the key a value is tracked under, once it is no longer resident only the
+ * key is remembered
+ */
+static inline page_id_t ReplacerKey(Page *const &page) {
+  return page->GetPageId();
+}
+// test only
+static inline page_id_t ReplacerKey(const int &value) { return value; }
+
+template <typename T>
+ARCReplacer<T>::ARCReplacer(size_t capacity, bool shares_capacity)
+    : capacity_(capacity), shares_capacity_(shares_capacity), target_(0),
+      size_(0) {}
+
+template <typename T> ARCReplacer<T>::~ARCReplacer() {}
+
+template <typename T>
+void ARCReplacer<T>::MoveTo(const Position &pos, ListId list) {
+  Entry entry = *pos.itr;
+  lists_[pos.list].erase(pos.itr);
+  lists_[list].push_front(entry);
+  index_[entry.key] = Position{list, lists_[list].begin()};
+}
+
+template <typename T> void ARCReplacer<T>::TrimGhosts() {
+  while (!lists_[B1].empty() &&
+         lists_[T1].size() + lists_[B1].size() > capacity_) {
+    index_.erase(lists_[B1].back().key);
+    lists_[B1].pop_back();
+  }
+  while (index_.size() > 2 * capacity_ && DropGhost())
+    ;
+  // the other replacers sharing the frames hold the rest of them
+  while (shares_capacity_ &&
+         lists_[B1].size() + lists_[B2].size() >
+             lists_[T1].size() + lists_[T2].size() &&
+         DropGhost())
+    ;
+}
+
+template <typename T> bool ARCReplacer<T>::DropGhost() {
+  ListId ghost = lists_[B2].empty() ? B1 : B2;
+  if (lists_[ghost].empty())
+    return false;
+  index_.erase(lists_[ghost].back().key);
+  lists_[ghost].pop_back();
+  return true;
+}
+
+template <typename T> bool ARCReplacer<T>::EvictFrom(ListId list, T &value) {
+  for (auto itr = lists_[list].rbegin(); itr != lists_[list].rend(); ++itr) {
+    if (!itr->evictable)
+      continue;
+    value = itr->value;
+    resident_.erase(value);
+    size_--;
+    itr->evictable = false;
+    MoveTo(Position{list, std::prev(itr.base())}, list == T1 ? B1 : B2);
+    TrimGhosts();
+    return true;
+  }
+  return false;
+}
+
+/*
+ * Reference value and make it evictable. A page seen for the first time goes
+ * to T1, a page referenced again or found in a ghost list goes to T2, and a
+ * ghost hit also moves the target size of T1 towards the list that missed it
+ */
+template <typename T> void ARCReplacer<T>::Insert(const T &value) {
+  std::lock_guard<std::mutex> guard(mtx);
+
+  page_id_t key = ReplacerKey(value);
+
+  // the frame was reused for another page without going through Victim
+  // (e.g. the page was deleted), forget the old page unless its id has
+  // been reused by another frame since
+  auto resident = resident_.find(value);
+  if (resident != resident_.end() && resident->second != key) {
+    auto old = index_.find(resident->second);
+    if (old != index_.end() && old->second.list <= T2 &&
+        old->second.itr->value == value) {
+      if (old->second.itr->evictable)
+        size_--;
+      lists_[old->second.list].erase(old->second.itr);
+      index_.erase(old);
+    }
+    resident_.erase(resident);
+  }
+
+  auto itr = index_.find(key);
+  if (itr == index_.end()) {
+    lists_[T1].push_front(Entry{key, value, true});
+    index_[key] = Position{T1, lists_[T1].begin()};
+    resident_[value] = key;
+    size_++;
+    TrimGhosts();
+    return;
+  }
+
+  Position pos = itr->second;
+  size_t b1_size = lists_[B1].size();
+  size_t b2_size = lists_[B2].size();
+  switch (pos.list) {
+  case B1:
+    target_ = std::min(capacity_,
+                       target_ + std::max<size_t>(1, b2_size / b1_size));
+    break;
+  case B2: {
+    size_t delta = std::max<size_t>(1, b1_size / b2_size);
+    target_ = target_ > delta ? target_ - delta : 0;
+    break;
+  }
+  default:
+    break;
+  }
+
+  // the page id moved to another frame (the page was deleted and the id
+  // reused), the old frame no longer holds it
+  if (pos.list <= T2 && pos.itr->value != value) {
+    auto old = resident_.find(pos.itr->value);
+    if (old != resident_.end() && old->second == key)
+      resident_.erase(old);
+  }
+  // ghost entries are never evictable
+  if (!pos.itr->evictable)
+    size_++;
+  pos.itr->value = value;
+  pos.itr->evictable = true;
+  resident_[value] = key;
+  MoveTo(pos, T2);
+  TrimGhosts();
+}
+
+/* Evict the LRU evictable page of T1 if T1 is larger than its target, of T2
+ * otherwise, falling back to the other list if the preferred one has nothing
+ * evictable. Return false if nothing is evictable
+ */
+template <typename T> bool ARCReplacer<T>::Victim(T &value) {
+  std::lock_guard<std::mutex> guard(mtx);
+
+  if (size_ == 0)
+    return false;
+
+  if (lists_[T1].size() > target_)
+    return EvictFrom(T1, value) || EvictFrom(T2, value);
+  return EvictFrom(T2, value) || EvictFrom(T1, value);
+}
+
+/*
+ * The page has been pinned: keep it resident but not evictable. If removal
+ * is successful, return true, otherwise return false
+ */
+template <typename T> bool ARCReplacer<T>::Erase(const T &value) {
+  std::lock_guard<std::mutex> guard(mtx);
+
+  auto resident = resident_.find(value);
+  if (resident == resident_.end())
+    return false;
+
+  Entry &entry = *index_[resident->second].itr;
+  if (!entry.evictable)
+    return false;
+  entry.evictable = false;
+  size_--;
+  return true;
+}
+
+template <typename T> size_t ARCReplacer<T>::Size() {
+  std::lock_guard<std::mutex> guard(mtx);
+  return size_;
+}
+
+/*
+ * The list Victim prefers right now first, LRU end first, then the other
+ */
+template <typename T>
+void ARCReplacer<T>::PeekVictims(std::vector<T> &values, size_t n) {
+  std::lock_guard<std::mutex> guard(mtx);
+
+  ListId first = lists_[T1].size() > target_ ? T1 : T2;
+  for (ListId list : {first, first == T1 ? T2 : T1}) {
+    for (auto itr = lists_[list].rbegin(); itr != lists_[list].rend() && n > 0;
+         ++itr) {
+      if (itr->evictable) {
+        values.push_back(itr->value);
+        n--;
+      }
+    }
+  }
+}
+
+template <typename T> size_t ARCReplacer<T>::GetTarget() {
+  std::lock_guard<std::mutex> guard(mtx);
+  return target_;
+}
+
+template <typename T> size_t ARCReplacer<T>::GetNumGhosts() {
+  std::lock_guard<std::mutex> guard(mtx);
+  return lists_[B1].size() + lists_[B2].size();
+}
+
+template class ARCReplacer<Page *>;
+// test only
+template class ARCReplacer<int>;
+
+} // namespace cmudb
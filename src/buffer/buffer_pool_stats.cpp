@@ -0,0 +1,184 @@
+/**
+ * buffer_pool_stats.cpp
+ */
+
+#include <iomanip>
+
+#include "buffer/buffer_pool_stats.h"
+
+namespace cmudb {
+
+std::string BufferPoolCounterToString(BufferPoolCounter counter) {
+  switch (counter) {
+  case BufferPoolCounter::FETCH_HIT:
+    return "fetch_hits";
+  case BufferPoolCounter::FETCH_MISS:
+    return "fetch_misses";
+  case BufferPoolCounter::EVICTION:
+    return "evictions";
+  case BufferPoolCounter::WRITE_BACK:
+    return "write_backs";
+  case BufferPoolCounter::BACKGROUND_WRITE:
+    return "background_writes";
+  case BufferPoolCounter::FLUSH:
+    return "flushes";
+  case BufferPoolCounter::NEW_PAGE:
+    return "new_pages";
+  case BufferPoolCounter::DELETE_PAGE:
+    return "deleted_pages";
+  case BufferPoolCounter::PREFETCH:
+    return "prefetched_pages";
+  case BufferPoolCounter::WARM_UP:
+    return "warmed_up_pages";
+  case BufferPoolCounter::LATCH_WAIT:
+    return "latch_waits";
+  case BufferPoolCounter::LATCH_WAIT_NS:
+    return "latch_wait_ns";
+  case BufferPoolCounter::NUM_COUNTERS:
+    break;
+  }
+  return "INVALID";
+}
+
+uint64_t LatencyHistogram::Count() const {
+  uint64_t count = 0;
+  for (int i = 0; i < STATS_LATENCY_BUCKETS; ++i)
+    count += buckets_[i];
+  return count;
+}
+
+uint64_t LatencyHistogram::Percentile(double percentile) const {
+  uint64_t count = Count();
+  if (count == 0)
+    return 0;
+  // rank of the operation at the percentile, counting from 1
+  uint64_t rank = static_cast<uint64_t>(count * percentile / 100.0);
+  if (rank == 0)
+    rank = 1;
+  uint64_t seen = 0;
+  for (int i = 0; i < STATS_LATENCY_BUCKETS; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank)
+      return 1ULL << i;
+  }
+  return 1ULL << (STATS_LATENCY_BUCKETS - 1);
+}
+
+LatencyHistogram &LatencyHistogram::operator-=(const LatencyHistogram &other) {
+  for (int i = 0; i < STATS_LATENCY_BUCKETS; ++i)
+    buckets_[i] -= other.buckets_[i];
+  return *this;
+}
+
+double BufferPoolStatsSnapshot::HitRatio() const {
+  uint64_t hits = Get(BufferPoolCounter::FETCH_HIT);
+  uint64_t fetches = hits + Get(BufferPoolCounter::FETCH_MISS);
+  return fetches == 0 ? 0 : static_cast<double>(hits) / fetches;
+}
+
+BufferPoolStatsSnapshot
+BufferPoolStatsSnapshot::Delta(const BufferPoolStatsSnapshot &since) const {
+  BufferPoolStatsSnapshot delta = *this;
+  for (int i = 0; i < static_cast<int>(BufferPoolCounter::NUM_COUNTERS); ++i)
+    delta.counters_[i] -= since.counters_[i];
+  delta.read_latency_ -= since.read_latency_;
+  delta.write_latency_ -= since.write_latency_;
+  return delta;
+}
+
+/*
+ * One counter per line, then the hit ratio, pinned frames, pool size and the
+ * median, 99th percentile and count of each latency histogram
+ */
+void BufferPoolStatsSnapshot::Dump(std::ostream &os) const {
+  for (int i = 0; i < static_cast<int>(BufferPoolCounter::NUM_COUNTERS); ++i) {
+    os << std::left << std::setw(20)
+       << BufferPoolCounterToString(static_cast<BufferPoolCounter>(i)) << " "
+       << counters_[i] << "\n";
+  }
+  os << std::left << std::setw(20) << "hit_ratio"
+     << " " << std::fixed << std::setprecision(4) << HitRatio() << "\n";
+  os << std::left << std::setw(20) << "pinned_frames"
+     << " " << pinned_frames_ << " (max " << max_pinned_frames_ << ")\n";
+  os << std::left << std::setw(20) << "pool_size"
+     << " " << pool_size_ << "\n";
+  os << std::left << std::setw(20) << "read_latency_us"
+     << " p50 <" << read_latency_.Percentile(50) << " p99 <"
+     << read_latency_.Percentile(99) << " n " << read_latency_.Count()
+     << "\n";
+  os << std::left << std::setw(20) << "write_latency_us"
+     << " p50 <" << write_latency_.Percentile(50) << " p99 <"
+     << write_latency_.Percentile(99) << " n " << write_latency_.Count()
+     << "\n";
+}
+
+BufferPoolStats::BufferPoolStats() {
+  for (auto &shard : shards_) {
+    for (auto &counter : shard.counters_)
+      counter = 0;
+    for (int i = 0; i < STATS_LATENCY_BUCKETS; ++i) {
+      shard.read_latency_[i] = 0;
+      shard.write_latency_[i] = 0;
+    }
+  }
+}
+
+/*
+ * Threads are dealt out to the shards round robin the first time they touch
+ * any BufferPoolStats, and keep that shard in every pool
+ */
+BufferPoolStats::Shard &BufferPoolStats::GetShard() {
+  static std::atomic<size_t> next_shard(0);
+  thread_local size_t shard =
+      next_shard.fetch_add(1, std::memory_order_relaxed) % STATS_NUM_SHARDS;
+  return shards_[shard];
+}
+
+size_t
+BufferPoolStats::LatencyBucket(std::chrono::steady_clock::duration latency) {
+  auto us =
+      std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+  size_t bucket = 0;
+  while (us > 0 && bucket < STATS_LATENCY_BUCKETS - 1) {
+    us >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+void BufferPoolStats::RecordReadLatency(
+    std::chrono::steady_clock::duration latency) {
+  GetShard().read_latency_[LatencyBucket(latency)].fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+void BufferPoolStats::RecordWriteLatency(
+    std::chrono::steady_clock::duration latency) {
+  GetShard().write_latency_[LatencyBucket(latency)].fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+/*
+ * The shards are read one after another while other threads keep counting,
+ * so a snapshot is not an atomic cut, but every counter is monotonic and
+ * the difference of two snapshots never goes negative
+ */
+BufferPoolStatsSnapshot BufferPoolStats::GetSnapshot() const {
+  BufferPoolStatsSnapshot snapshot;
+  snapshot.time_ = std::chrono::steady_clock::now();
+  for (auto &shard : shards_) {
+    for (int i = 0; i < static_cast<int>(BufferPoolCounter::NUM_COUNTERS);
+         ++i)
+      snapshot.counters_[i] +=
+          shard.counters_[i].load(std::memory_order_relaxed);
+    for (int i = 0; i < STATS_LATENCY_BUCKETS; ++i) {
+      snapshot.read_latency_.buckets_[i] +=
+          shard.read_latency_[i].load(std::memory_order_relaxed);
+      snapshot.write_latency_.buckets_[i] +=
+          shard.write_latency_[i].load(std::memory_order_relaxed);
+    }
+  }
+  return snapshot;
+}
+
+} // namespace cmudb
@@ -0,0 +1,175 @@
+/**
+ * CLOCK implementation
+ */
+#include <algorithm>
+
+#include "buffer/clock_replacer.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+/*
+ * the slot a value lives in
+ */
+static inline size_t ClockSlot(Page *const &page) {
+  return page->GetFrameId();
+}
+// test only
+static inline size_t ClockSlot(const int &value) {
+  return static_cast<size_t>(value);
+}
+
+template <typename T> ClockReplacer<T>::Chunk::Chunk() {
+  for (size_t i = 0; i < CHUNK_SLOTS; ++i) {
+    values[i].store(T(), std::memory_order_relaxed);
+    evictable[i].store(false, std::memory_order_relaxed);
+    ref[i].store(false, std::memory_order_relaxed);
+  }
+}
+
+template <typename T>
+ClockReplacer<T>::Directory::Directory(size_t size)
+    : size(size), chunks(new std::atomic<Chunk *>[size]) {
+  for (size_t i = 0; i < size; ++i) {
+    chunks[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+template <typename T>
+ClockReplacer<T>::ClockReplacer() : num_slots_(0), size_(0), hand_(0) {
+  directories_.emplace_back(new Directory(1));
+  directory_.store(directories_.back().get());
+}
+
+template <typename T> ClockReplacer<T>::~ClockReplacer() {}
+
+/*
+ * Allocate the chunk of slot, and a larger directory first if it does not
+ * reach that far
+ */
+template <typename T>
+typename ClockReplacer<T>::Chunk *ClockReplacer<T>::AddChunk(size_t slot) {
+  std::lock_guard<std::mutex> guard(mtx);
+
+  size_t index = slot / CHUNK_SLOTS;
+  Directory *directory = directory_.load(std::memory_order_relaxed);
+  if (index >= directory->size) {
+    Directory *larger =
+        new Directory(std::max(2 * directory->size, index + 1));
+    for (size_t i = 0; i < directory->size; ++i) {
+      larger->chunks[i].store(directory->chunks[i].load(),
+                              std::memory_order_relaxed);
+    }
+    directories_.emplace_back(larger);
+    directory_.store(larger, std::memory_order_release);
+    directory = larger;
+  }
+
+  Chunk *chunk = directory->chunks[index].load(std::memory_order_relaxed);
+  if (chunk == nullptr) {
+    chunk = new Chunk;
+    chunks_.emplace_back(chunk);
+    directory->chunks[index].store(chunk, std::memory_order_release);
+  }
+  return chunk;
+}
+
+/*
+ * Make value evictable and give it a second chance
+ */
+template <typename T> void ClockReplacer<T>::Insert(const T &value) {
+  size_t slot = ClockSlot(value);
+  Chunk *chunk = FindChunk(slot);
+  if (chunk == nullptr)
+    chunk = AddChunk(slot);
+
+  size_t num_slots = num_slots_.load(std::memory_order_relaxed);
+  while (slot >= num_slots &&
+         !num_slots_.compare_exchange_weak(num_slots, slot + 1))
+    ;
+
+  size_t i = slot % CHUNK_SLOTS;
+  chunk->values[i].store(value, std::memory_order_relaxed);
+  chunk->ref[i].store(true, std::memory_order_relaxed);
+  // publishes the value to Victim
+  if (!chunk->evictable[i].exchange(true, std::memory_order_acq_rel))
+    size_.fetch_add(1);
+}
+
+/* Sweep the hand until an evictable slot with a clear reference bit is
+ * found, clearing reference bits on the way. Two full turns are enough since
+ * the first one clears every bit; a third one ignores the bits in case
+ * concurrent Inserts keep setting them. Return false if nothing is evictable
+ */
+template <typename T> bool ClockReplacer<T>::Victim(T &value) {
+  std::lock_guard<std::mutex> guard(mtx);
+
+  size_t num_slots = num_slots_.load();
+  for (size_t step = 0; size_.load() > 0 && step < 3 * num_slots; ++step) {
+    size_t slot = hand_;
+    hand_ = (hand_ + 1) % num_slots;
+    Chunk *chunk = FindChunk(slot);
+    size_t i = slot % CHUNK_SLOTS;
+    if (chunk == nullptr ||
+        !chunk->evictable[i].load(std::memory_order_acquire))
+      continue;
+    if (step < 2 * num_slots &&
+        chunk->ref[i].exchange(false, std::memory_order_relaxed))
+      continue;
+    // an Erase may have won meanwhile
+    if (chunk->evictable[i].exchange(false, std::memory_order_acq_rel)) {
+      size_.fetch_sub(1);
+      value = chunk->values[i].load(std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Remove value from the replacer. If removal is successful, return true,
+ * otherwise return false
+ */
+template <typename T> bool ClockReplacer<T>::Erase(const T &value) {
+  size_t slot = ClockSlot(value);
+  Chunk *chunk = FindChunk(slot);
+  if (chunk == nullptr ||
+      !chunk->evictable[slot % CHUNK_SLOTS].exchange(
+          false, std::memory_order_acq_rel))
+    return false;
+
+  size_.fetch_sub(1);
+  return true;
+}
+
+template <typename T> size_t ClockReplacer<T>::Size() { return size_.load(); }
+
+/*
+ * Walk one turn from the hand: slots whose reference bit is clear would go
+ * first, then the referenced ones in hand order
+ */
+template <typename T>
+void ClockReplacer<T>::PeekVictims(std::vector<T> &values, size_t n) {
+  std::lock_guard<std::mutex> guard(mtx);
+
+  size_t num_slots = num_slots_.load();
+  for (bool ref : {false, true}) {
+    for (size_t k = 0; k < num_slots && n > 0; k++) {
+      size_t slot = (hand_ + k) % num_slots;
+      Chunk *chunk = FindChunk(slot);
+      size_t i = slot % CHUNK_SLOTS;
+      if (chunk != nullptr &&
+          chunk->evictable[i].load(std::memory_order_acquire) &&
+          chunk->ref[i].load(std::memory_order_relaxed) == ref) {
+        values.push_back(chunk->values[i].load(std::memory_order_relaxed));
+        n--;
+      }
+    }
+  }
+}
+
+template class ClockReplacer<Page *>;
+// test only
+template class ClockReplacer<int>;
+
+} // namespace cmudb
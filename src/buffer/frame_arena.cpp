@@ -0,0 +1,130 @@
+/**
+ * frame_arena.cpp
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+#include <unistd.h>
+
+#include "buffer/frame_arena.h"
+#include "common/logger.h"
+
+namespace cmudb {
+
+static inline size_t RoundUp(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+#ifdef __linux__
+/*
+ * Map size zeroed bytes, a multiple of the system page size, at a multiple
+ * of alignment: map enough more to find an aligned start in, then unmap
+ * what lies before and after
+ */
+static char *MapAligned(size_t size, size_t alignment) {
+  size_t system_page_size = sysconf(_SC_PAGESIZE);
+  size_t extra = alignment > system_page_size ? alignment - system_page_size
+                                              : 0;
+  void *memory = mmap(nullptr, size + extra, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED)
+    throw std::bad_alloc();
+  char *start = reinterpret_cast<char *>(
+      RoundUp(reinterpret_cast<uintptr_t>(memory), alignment));
+  size_t head = start - static_cast<char *>(memory);
+  if (head != 0)
+    munmap(memory, head);
+  if (head != extra)
+    munmap(start + size, extra - head);
+  return start;
+}
+#endif
+
+FrameArena::FrameArena(size_t num_frames, size_t page_size,
+                       HugePageMode huge_page_mode)
+    : num_frames_(num_frames), page_size_(page_size),
+      data_size_(RoundUp(num_frames * page_size, sysconf(_SC_PAGESIZE))),
+      stride_(RoundUp(sizeof(Page), CACHELINE_SIZE)),
+      memory_size_(data_size_ + num_frames * stride_),
+      huge_page_mode_(huge_page_mode), memory_(nullptr), released_(false) {
+  Allocate();
+  for (size_t i = 0; i < num_frames_; ++i) {
+    Page *page = new (GetPage(i)) Page();
+    page->data_ = memory_ + i * page_size_;
+    page->page_size_ = page_size_;
+  }
+}
+
+FrameArena::~FrameArena() {
+  for (size_t i = 0; i < num_frames_; ++i) {
+    GetPage(i)->~Page();
+  }
+#ifdef __linux__
+  munmap(memory_, memory_size_);
+#else
+  free(memory_);
+#endif
+}
+
+/*
+ * Map memory_size_ zeroed bytes in the requested mode, adjusting
+ * memory_size_ to what was mapped and huge_page_mode_ to what was used
+ */
+void FrameArena::Allocate() {
+#ifdef __linux__
+  if (huge_page_mode_ == HugePageMode::HUGETLB) {
+    size_t size = RoundUp(memory_size_, HUGE_PAGE_SIZE);
+    void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (memory != MAP_FAILED) {
+      memory_ = static_cast<char *>(memory);
+      memory_size_ = size;
+      return;
+    }
+    LOG_DEBUG("no huge pages reserved, using transparent huge pages");
+    huge_page_mode_ = HugePageMode::TRANSPARENT;
+  }
+
+  if (huge_page_mode_ == HugePageMode::TRANSPARENT) {
+    // only aligned huge pages can back the mapping
+    size_t size = RoundUp(memory_size_, HUGE_PAGE_SIZE);
+    memory_ = MapAligned(size, HUGE_PAGE_SIZE);
+    madvise(memory_, size, MADV_HUGEPAGE);
+    memory_size_ = size;
+    return;
+  }
+
+  // mmap only aligns to the system page size, pages may be larger
+  memory_size_ = RoundUp(memory_size_, sysconf(_SC_PAGESIZE));
+  memory_ = MapAligned(memory_size_, page_size_);
+#else
+  void *memory = nullptr;
+  if (posix_memalign(&memory, page_size_, memory_size_) != 0)
+    throw std::bad_alloc();
+  memset(memory, 0, memory_size_);
+  memory_ = static_cast<char *>(memory);
+  huge_page_mode_ = HugePageMode::NONE;
+#endif
+}
+
+/*
+ * Hand the page data back to the system, the descriptors stay. Huge pages
+ * from the reserved pool can only be dropped whole, a partial one at the end
+ * is kept
+ */
+void FrameArena::ReleaseData() {
+#ifdef __linux__
+  size_t size = data_size_;
+  if (huge_page_mode_ == HugePageMode::HUGETLB)
+    size = size / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  if (size != 0)
+    madvise(memory_, size, MADV_DONTNEED);
+#endif
+  released_ = true;
+}
+
+} // namespace cmudb
@@ -0,0 +1,149 @@
+/**
+ * LRU-K implementation
+ */
+#include "buffer/lru_k_replacer.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+template <typename T>
+LRUKReplacer<T>::LRUKReplacer(size_t k, size_t correlated_period)
+    : k_(k == 0 ? 1 : k), correlated_period_(correlated_period),
+      current_timestamp_(0) {}
+
+template <typename T> LRUKReplacer<T>::~LRUKReplacer() {}
+
+/*
+ * Frames with fewer than K references sort first (by last reference), the
+ * rest by their K-th most recent reference
+ */
+template <typename T>
+typename LRUKReplacer<T>::Key
+LRUKReplacer<T>::GetKey(const Entry &entry) const {
+  if (entry.history.size() < k_)
+    return Key(false, entry.history.front());
+  return Key(true, entry.history.back());
+}
+
+/*
+ * Pop the references whose correlated period is over. A value whose last
+ * reference that still is moves over to order_
+ */
+template <typename T> void LRUKReplacer<T>::EndBursts() {
+  while (!bursts_.empty() &&
+         current_timestamp_ - bursts_.front().first > correlated_period_) {
+    auto itr = entries_.find(bursts_.front().second);
+    if (itr != entries_.end() && itr->second.correlated &&
+        itr->second.history.front() == bursts_.front().first) {
+      Entry &entry = itr->second;
+      std::pair<Key, T> item = *entry.pos;
+      correlated_.erase(entry.pos);
+      entry.correlated = false;
+      entry.pos = order_.insert(item).first;
+    }
+    bursts_.pop_front();
+  }
+}
+
+template <typename T> void LRUKReplacer<T>::Unlink(Entry &entry) {
+  if (entry.correlated)
+    correlated_.erase(entry.pos);
+  else
+    order_.erase(entry.pos);
+  entry.correlated = false;
+}
+
+/*
+ * Record a reference to value and make it evictable
+ */
+template <typename T> void LRUKReplacer<T>::Insert(const T &value) {
+  std::lock_guard<std::mutex> guard(mtx);
+
+  size_t now = ++current_timestamp_;
+  Entry &entry = entries_[value];
+  if (entry.evictable)
+    Unlink(entry);
+
+  if (!entry.history.empty() &&
+      now - entry.history.front() <= correlated_period_) {
+    // correlated reference, only refresh the last timestamp
+    entry.history.front() = now;
+  } else {
+    entry.history.insert(entry.history.begin(), now);
+    if (entry.history.size() > k_)
+      entry.history.pop_back();
+  }
+
+  entry.evictable = true;
+  if (correlated_period_ > 0) {
+    entry.correlated = true;
+    entry.pos = correlated_.insert(std::make_pair(GetKey(entry), value)).first;
+    bursts_.emplace_back(now, value);
+  } else {
+    entry.pos = order_.insert(std::make_pair(GetKey(entry), value)).first;
+  }
+  EndBursts();
+}
+
+/* Evict the value with the largest backward K-distance that is outside its
+ * correlated period, or the largest overall if every value is inside it.
+ * The history of the evicted value is dropped. Return false if the replacer
+ * is empty
+ */
+template <typename T> bool LRUKReplacer<T>::Victim(T &value) {
+  std::lock_guard<std::mutex> guard(mtx);
+
+  EndBursts();
+  if (order_.empty() && correlated_.empty())
+    return false;
+
+  value = order_.empty() ? correlated_.begin()->second
+                         : order_.begin()->second;
+  Unlink(entries_[value]);
+  entries_.erase(value);
+  return true;
+}
+
+/*
+ * Remove value from the replacer (it has been pinned), keeping its history.
+ * If removal is successful, return true, otherwise return false
+ */
+template <typename T> bool LRUKReplacer<T>::Erase(const T &value) {
+  std::lock_guard<std::mutex> guard(mtx);
+
+  auto itr = entries_.find(value);
+  if (itr == entries_.end() || !itr->second.evictable)
+    return false;
+
+  Unlink(itr->second);
+  itr->second.evictable = false;
+  return true;
+}
+
+template <typename T> size_t LRUKReplacer<T>::Size() {
+  std::lock_guard<std::mutex> guard(mtx);
+  return order_.size() + correlated_.size();
+}
+
+/*
+ * In the order Victim would evict them: outside their correlated period
+ * first, then the rest
+ */
+template <typename T>
+void LRUKReplacer<T>::PeekVictims(std::vector<T> &values, size_t n) {
+  std::lock_guard<std::mutex> guard(mtx);
+
+  EndBursts();
+  for (auto *order : {&order_, &correlated_}) {
+    for (auto itr = order->begin(); itr != order->end() && n > 0;
+         ++itr, --n) {
+      values.push_back(itr->second);
+    }
+  }
+}
+
+template class LRUKReplacer<Page *>;
+// test only
+template class LRUKReplacer<int>;
+
+} // namespace cmudb
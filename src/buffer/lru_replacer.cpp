@@ -65,6 +65,18 @@ template <typename T> bool LRUReplacer<T>::Erase(const T &value) {
 
 template <typename T> size_t LRUReplacer<T>::Size() { return this->list.size(); }
 
+/*
+ * The least recently used values come first
+ */
+template <typename T>
+void LRUReplacer<T>::PeekVictims(std::vector<T> &values, size_t n) {
+  std::lock_guard<std::mutex> guard(mtx);
+
+  for (auto itr = list.rbegin(); itr != list.rend() && n > 0; ++itr, --n) {
+    values.push_back(*itr);
+  }
+}
+
 template class LRUReplacer<Page *>;
 // test only
 template class LRUReplacer<int>;
@@ -0,0 +1,120 @@
+/**
+ * priority_replacer.cpp
+ */
+
+#include "buffer/priority_replacer.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+template <typename T>
+PriorityReplacer<T>::PriorityReplacer(const std::vector<Replacer<T> *> &levels)
+    : levels_(levels) {}
+
+template <typename T> PriorityReplacer<T>::~PriorityReplacer() {
+  for (Replacer<T> *level : levels_)
+    delete level;
+}
+
+template <>
+PagePriority PriorityReplacer<Page *>::GetLevel(Page *const &page) {
+  return page->replacer_priority_;
+}
+
+template <>
+void PriorityReplacer<Page *>::SetLevel(Page *const &page,
+                                        PagePriority level) {
+  page->replacer_priority_ = level;
+}
+
+// test only
+template <> PagePriority PriorityReplacer<int>::GetLevel(const int &value) {
+  auto itr = int_levels_.find(value);
+  return itr == int_levels_.end() ? PagePriority::NUM_PRIORITIES
+                                  : itr->second;
+}
+
+template <>
+void PriorityReplacer<int>::SetLevel(const int &value, PagePriority level) {
+  if (level == PagePriority::NUM_PRIORITIES)
+    int_levels_.erase(value);
+  else
+    int_levels_[value] = level;
+}
+
+template <> void PriorityReplacer<Page *>::Insert(Page *const &page) {
+  Insert(page, page->priority_);
+}
+
+// test only
+template <> void PriorityReplacer<int>::Insert(const int &value) {
+  PagePriority level = GetLevel(value);
+  Insert(value, level == PagePriority::NUM_PRIORITIES ? PagePriority::HEAP
+                                                      : level);
+}
+
+/*
+ * Insert value with priority, moving it out of the order of its old
+ * priority if that was a different one
+ */
+template <typename T>
+void PriorityReplacer<T>::Insert(const T &value, PagePriority priority) {
+  PagePriority level = GetLevel(value);
+  if (level != priority && level != PagePriority::NUM_PRIORITIES)
+    levels_[static_cast<int>(level)]->Erase(value);
+  SetLevel(value, priority);
+  levels_[static_cast<int>(priority)]->Insert(value);
+}
+
+/*
+ * Victim of the lowest priority that has one
+ */
+template <typename T> bool PriorityReplacer<T>::Victim(T &value) {
+  for (Replacer<T> *level : levels_) {
+    if (level->Victim(value)) {
+      SetLevel(value, PagePriority::NUM_PRIORITIES);
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename T> bool PriorityReplacer<T>::Erase(const T &value) {
+  PagePriority level = GetLevel(value);
+  if (level == PagePriority::NUM_PRIORITIES)
+    return false;
+  SetLevel(value, PagePriority::NUM_PRIORITIES);
+  return levels_[static_cast<int>(level)]->Erase(value);
+}
+
+template <typename T> size_t PriorityReplacer<T>::Size() {
+  size_t size = 0;
+  for (Replacer<T> *level : levels_)
+    size += level->Size();
+  return size;
+}
+
+template <typename T>
+size_t PriorityReplacer<T>::Size(PagePriority priority) {
+  return levels_[static_cast<int>(priority)]->Size();
+}
+
+/*
+ * Lower priorities first, each in the order of its own replacer
+ */
+template <typename T>
+void PriorityReplacer<T>::PeekVictims(std::vector<T> &values, size_t n) {
+  for (Replacer<T> *level : levels_) {
+    size_t before = values.size();
+    if (n == 0)
+      break;
+    level->PeekVictims(values, n);
+    n -= values.size() - before;
+  }
+}
+
+template class PriorityReplacer<Page *>;
+// test only
+template class PriorityReplacer<int>;
+
+} // namespace cmudb
@@ -0,0 +1,361 @@
+/**
+ * async_io.cpp
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#include "common/config.h"
+#include "common/logger.h"
+#include "disk/async_io.h"
+
+namespace cmudb {
+
+size_t ReadFully(int fd, char *data, size_t size, off_t offset) {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t n = pread(fd, data + done, size - done, offset + done);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      break;
+    done += n;
+  }
+  return done;
+}
+
+size_t WriteFully(int fd, const char *data, size_t size, off_t offset) {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t n = pwrite(fd, data + done, size - done, offset + done);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      break;
+    done += n;
+  }
+  return done;
+}
+
+void AsyncIO::Complete(int fd, AsyncIORequest *request, ssize_t result) {
+  // an interrupted request is retried from scratch, a short one finished
+  if (result == -EINTR || result == -EAGAIN)
+    result = 0;
+  bool ok = result >= 0;
+  size_t done = ok ? result : 0;
+  if (ok && done < request->size_) {
+    if (request->write_) {
+      done += WriteFully(fd, request->data_ + done, request->size_ - done,
+                         request->offset_ + done);
+      ok = done == request->size_;
+    } else {
+      done += ReadFully(fd, request->data_ + done, request->size_ - done,
+                        request->offset_ + done);
+    }
+  }
+  if (!request->write_ && done < request->size_)
+    memset(request->data_ + done, 0, request->size_ - done);
+  if (!ok) {
+    LOG_DEBUG("I/O error in asynchronous %s",
+              request->write_ ? "write" : "read");
+  }
+
+  if (request->on_complete_)
+    request->on_complete_(done);
+  request->promise_.set_value(ok);
+  delete request;
+}
+
+/*
+ * A few threads doing the requests one at a time with pread/pwrite
+ */
+class ThreadPoolAsyncIO : public AsyncIO {
+public:
+  ThreadPoolAsyncIO(int fd, size_t num_threads) : fd_(fd), stopping_(false) {
+    for (size_t i = 0; i < num_threads; ++i)
+      threads_.emplace_back(&ThreadPoolAsyncIO::WorkerLoop, this);
+  }
+
+  ~ThreadPoolAsyncIO() {
+    {
+      std::lock_guard<std::mutex> guard(latch_);
+      stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto &thread : threads_)
+      thread.join();
+  }
+
+  void Submit(std::vector<AsyncIORequest *> &requests) override {
+    {
+      std::lock_guard<std::mutex> guard(latch_);
+      queue_.insert(queue_.end(), requests.begin(), requests.end());
+    }
+    cv_.notify_all();
+  }
+
+  AsyncIOType GetType() const override { return AsyncIOType::THREAD_POOL; }
+
+private:
+  // the queue is drained before the threads stop
+  void WorkerLoop() {
+    std::unique_lock<std::mutex> lock(latch_);
+    while (true) {
+      cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+      if (queue_.empty())
+        return;
+      AsyncIORequest *request = queue_.front();
+      queue_.pop_front();
+      lock.unlock();
+      ssize_t result =
+          request->write_
+              ? pwrite(fd_, request->data_, request->size_, request->offset_)
+              : pread(fd_, request->data_, request->size_, request->offset_);
+      Complete(fd_, request, result < 0 ? -errno : result);
+      lock.lock();
+    }
+  }
+
+  int fd_;
+  std::vector<std::thread> threads_;
+  std::deque<AsyncIORequest *> queue_;
+  std::mutex latch_;
+  std::condition_variable cv_;
+  bool stopping_;
+};
+
+#ifdef __linux__
+/*
+ * Submission and completion rings shared with the kernel. Submitters fill
+ * submission queue entries under latch_ and publish them by moving the
+ * tail; the reaper thread waits in io_uring_enter and consumes completions.
+ * At most sq_entries_ requests are in flight, so the completion ring (twice
+ * as large) never overflows
+ */
+class IOUringAsyncIO : public AsyncIO {
+public:
+  IOUringAsyncIO(int fd) : fd_(fd), ring_fd_(-1), in_flight_(0) {}
+
+  ~IOUringAsyncIO() {
+    if (ring_fd_ < 0)
+      return;
+    if (reaper_.joinable()) {
+      std::unique_lock<std::mutex> lock(latch_);
+      cv_.wait(lock, [this] { return in_flight_ == 0; });
+      // a nop without a request tells the reaper to stop
+      io_uring_sqe *sqe = NextEntry();
+      sqe->opcode = IORING_OP_NOP;
+      sqe->user_data = 0;
+      PushEntry();
+      Enter(1);
+      lock.unlock();
+      reaper_.join();
+    }
+    munmap(sqes_, sqes_size_);
+    munmap(cq_ring_, cq_ring_size_);
+    if (sq_ring_ != cq_ring_)
+      munmap(sq_ring_, sq_ring_size_);
+    close(ring_fd_);
+  }
+
+  // false if the kernel does not let us set up a ring
+  bool Setup(size_t queue_depth) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring_fd_ = syscall(__NR_io_uring_setup, queue_depth, &params);
+    if (ring_fd_ < 0)
+      return false;
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    // newer kernels map both rings at once
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+      cq_ring_size_ = sq_ring_size_;
+    }
+    sq_ring_ = MapRing(sq_ring_size_, IORING_OFF_SQ_RING);
+    cq_ring_ = single_mmap ? sq_ring_
+                           : MapRing(cq_ring_size_, IORING_OFF_CQ_RING);
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = reinterpret_cast<io_uring_sqe *>(
+        MapRing(sqes_size_, IORING_OFF_SQES));
+    if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED ||
+        sqes_ == MAP_FAILED) {
+      if (sqes_ != MAP_FAILED)
+        munmap(sqes_, sqes_size_);
+      if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_)
+        munmap(cq_ring_, cq_ring_size_);
+      if (sq_ring_ != MAP_FAILED)
+        munmap(sq_ring_, sq_ring_size_);
+      close(ring_fd_);
+      ring_fd_ = -1;
+      return false;
+    }
+
+    sq_entries_ = params.sq_entries;
+    sq_tail_ = reinterpret_cast<unsigned *>(sq_ring_ + params.sq_off.tail);
+    sq_mask_ =
+        *reinterpret_cast<unsigned *>(sq_ring_ + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq_ring_ + params.sq_off.array);
+    cq_head_ = reinterpret_cast<unsigned *>(cq_ring_ + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq_ring_ + params.cq_off.tail);
+    cq_mask_ =
+        *reinterpret_cast<unsigned *>(cq_ring_ + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq_ring_ + params.cq_off.cqes);
+    reaper_ = std::thread(&IOUringAsyncIO::ReaperLoop, this);
+    return true;
+  }
+
+  void Submit(std::vector<AsyncIORequest *> &requests) override {
+    std::unique_lock<std::mutex> lock(latch_);
+    unsigned pending = 0;
+    for (AsyncIORequest *request : requests) {
+      if (in_flight_ == sq_entries_) {
+        // hand what we have to the kernel before waiting for room
+        Enter(pending);
+        pending = 0;
+        cv_.wait(lock, [this] { return in_flight_ < sq_entries_; });
+      }
+      request->iov_.iov_base = request->data_;
+      request->iov_.iov_len = request->size_;
+      io_uring_sqe *sqe = NextEntry();
+      sqe->opcode = request->write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+      sqe->fd = fd_;
+      sqe->addr = reinterpret_cast<uint64_t>(&request->iov_);
+      sqe->len = 1;
+      sqe->off = request->offset_;
+      sqe->user_data = reinterpret_cast<uint64_t>(request);
+      PushEntry();
+      in_flight_++;
+      pending++;
+    }
+    Enter(pending);
+  }
+
+  AsyncIOType GetType() const override { return AsyncIOType::IO_URING; }
+
+private:
+  char *MapRing(size_t size, off_t offset) {
+    return static_cast<char *>(mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_POPULATE, ring_fd_,
+                                    offset));
+  }
+
+  // zeroed submission queue entry at the tail, to be filled in and then
+  // published with PushEntry. Caller holds latch_
+  io_uring_sqe *NextEntry() {
+    unsigned index = *sq_tail_ & sq_mask_;
+    io_uring_sqe *sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    return sqe;
+  }
+
+  void PushEntry() {
+    __atomic_store_n(sq_tail_, *sq_tail_ + 1, __ATOMIC_RELEASE);
+  }
+
+  // submit count published entries. Caller holds latch_
+  void Enter(unsigned count) {
+    while (count > 0) {
+      int submitted = syscall(__NR_io_uring_enter, ring_fd_, count, 0, 0,
+                              nullptr, 0);
+      if (submitted < 0) {
+        if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+          continue;
+        LOG_DEBUG("io_uring_enter failed: %s", strerror(errno));
+        return;
+      }
+      count -= submitted;
+    }
+  }
+
+  void ReaperLoop() {
+    while (true) {
+      syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS,
+              nullptr, 0);
+      unsigned head = *cq_head_;
+      unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      {
+        // the requests reached us through the kernel; pass through the latch
+        // their submitter held so the ordering is visible to the tools too
+        std::lock_guard<std::mutex> guard(latch_);
+      }
+      size_t completed = 0;
+      bool stop = false;
+      for (; head != tail; ++head) {
+        io_uring_cqe *cqe = &cqes_[head & cq_mask_];
+        AsyncIORequest *request =
+            reinterpret_cast<AsyncIORequest *>(cqe->user_data);
+        if (request == nullptr) {
+          stop = true;
+          continue;
+        }
+        Complete(fd_, request, cqe->res);
+        completed++;
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+      if (completed > 0) {
+        std::lock_guard<std::mutex> guard(latch_);
+        in_flight_ -= completed;
+        cv_.notify_all();
+      }
+      if (stop)
+        return;
+    }
+  }
+
+  int fd_;
+  int ring_fd_;
+  char *sq_ring_;
+  char *cq_ring_;
+  io_uring_sqe *sqes_;
+  size_t sq_ring_size_;
+  size_t cq_ring_size_;
+  size_t sqes_size_;
+  unsigned sq_entries_;
+  unsigned *sq_tail_;
+  unsigned sq_mask_;
+  unsigned *sq_array_;
+  unsigned *cq_head_;
+  unsigned *cq_tail_;
+  unsigned cq_mask_;
+  io_uring_cqe *cqes_;
+  std::thread reaper_;
+  std::mutex latch_;
+  std::condition_variable cv_; // signalled when requests complete
+  unsigned in_flight_;
+};
+#endif
+
+AsyncIO *AsyncIO::Create(AsyncIOType async_io_type, int fd,
+                         size_t queue_depth) {
+#ifdef __linux__
+  if (async_io_type == AsyncIOType::IO_URING) {
+    IOUringAsyncIO *async_io = new IOUringAsyncIO(fd);
+    if (async_io->Setup(queue_depth))
+      return async_io;
+    LOG_DEBUG("io_uring unavailable, using a thread pool");
+    delete async_io;
+  }
+#else
+  (void)queue_depth;
+#endif
+  return new ThreadPoolAsyncIO(fd, ASYNC_IO_THREADS);
+}
+
+} // namespace cmudb
@@ -2,31 +2,55 @@
  * disk_manager.cpp
  */
 #include <assert.h>
+#include <cerrno>
 #include <cstring>
+#include <fcntl.h>
 #include <iostream>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <thread>
+#include <unistd.h>
 
 #include "common/logger.h"
+#include "disk/async_io.h"
 #include "disk/disk_manager.h"
+#include "page/header_page.h"
 
 namespace cmudb {
 
 static char *buffer_used = nullptr;
 
+static bool IsValidPageSize(int page_size) {
+  return page_size >= MIN_PAGE_SIZE && page_size <= MAX_PAGE_SIZE &&
+         (page_size & (page_size - 1)) == 0;
+}
+
 /**
- * Constructor: open/create a single database file & log file
+ * Constructor: open/create a single database file, its log file and its free
+ * space map
  * @input db_file: database file name
+ * @input page_size, pool_size: parameters of a new database, an existing one
+ * keeps the parameters recorded in its header page
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), next_page_id_(0), num_flushes_(0), flush_log_(false),
+DiskManager::DiskManager(const std::string &db_file, int page_size,
+                         int pool_size)
+    : db_fd_(-1), db_file_size_(0), read_mode_(ReadMode::PREAD),
+      db_map_(nullptr), async_io_type_(AsyncIOType::IO_URING),
+      async_io_(nullptr), file_name_(db_file), page_size_(page_size),
+      pool_size_(pool_size), num_flushes_(0), flush_log_(false),
       flush_log_f_(nullptr) {
+  if (!IsValidPageSize(page_size_)) {
+    LOG_INFO("invalid page size %d, using %d", page_size_, PAGE_SIZE);
+    page_size_ = PAGE_SIZE;
+  }
+
   std::string::size_type n = file_name_.find(".");
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
+  fsm_name_ = file_name_.substr(0, n) + ".fsm";
 
   log_io_.open(log_name_,
                std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
@@ -42,64 +66,203 @@ DiskManager::DiskManager(const std::string &db_file)
                                 std::ios::out);
   }
 
-  db_io_.open(db_file,
-              std::ios::binary | std::ios::in | std::ios::out | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+  db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (db_fd_ < 0) {
+    LOG_DEBUG("cannot open %s: %s", db_file.c_str(), strerror(errno));
+    return;
   }
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) == 0)
+    db_file_size_ = stat_buf.st_size;
+
+  // parameters of an existing database
+  char parameters[HeaderPage::DB_PARAMETERS_SIZE];
+  int stored_page_size, stored_pool_size;
+  if (db_file_size_ >= HeaderPage::DB_PARAMETERS_SIZE &&
+      ReadFully(db_fd_, parameters, HeaderPage::DB_PARAMETERS_SIZE,
+                static_cast<off_t>(HEADER_PAGE_ID) * page_size_) ==
+          HeaderPage::DB_PARAMETERS_SIZE) {
+    if (HeaderPage::GetDatabaseParameters(parameters, stored_page_size,
+                                          stored_pool_size) &&
+        IsValidPageSize(stored_page_size) && stored_pool_size > 0) {
+      page_size_ = stored_page_size;
+      pool_size_ = stored_pool_size;
+    }
+  }
+
+  // an empty db file is a new database, whatever map was left behind
+  free_space_map_.Open(fsm_name_, page_size_, GetNumPages(),
+                       db_file_size_ == 0);
 }
 
 DiskManager::~DiskManager() {
-  db_io_.close();
+  // waits for the asynchronous I/O in flight
+  delete async_io_;
+  if (db_map_ != nullptr)
+    munmap(db_map_, MMAP_RESERVE_SIZE);
+  if (db_fd_ >= 0)
+    close(db_fd_);
   log_io_.close();
 }
 
+/*
+ * A write ending at end may have grown the file: raise the cached file size
+ * to it, racing writers leave the largest end behind
+ */
+void DiskManager::ExtendFileSize(int64_t end) {
+  int64_t size = db_file_size_.load();
+  while (size < end && !db_file_size_.compare_exchange_weak(size, end)) {
+  }
+}
+
 /**
  * Write the contents of the specified page into disk file
+ * The write goes to the operating system right away, like the flush of the
+ * stream this replaces; it is not synced to the disk
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = page_id * PAGE_SIZE;
-  // set write cursor to offset
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
+  WritePages(page_id, page_data, 1);
+}
+
+/**
+ * Write num_pages consecutive pages, starting at first_page_id, with a single
+ * system call
+ */
+void DiskManager::WritePages(page_id_t first_page_id, const char *pages_data,
+                             int num_pages) {
+  off_t offset = static_cast<off_t>(first_page_id) * page_size_;
+  size_t size = static_cast<size_t>(num_pages) * page_size_;
+  size_t written = WriteFully(db_fd_, pages_data, size, offset);
+  if (written < size) {
     LOG_DEBUG("I/O error while writing");
-    return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  ExtendFileSize(offset + written);
 }
 
 /**
  * Read the contents of the specified page into the given memory area
+ * Reads need no latch: every thread reads at its own offset, and the file
+ * size is cached instead of asked for on every read. In MMAP mode a page
+ * inside the file is copied from the mapping without a system call
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  int offset = page_id * PAGE_SIZE;
+  const char *mapped = GetPageView(page_id);
+  if (mapped != nullptr) {
+    memcpy(page_data, mapped, page_size_);
+    return;
+  }
+  off_t offset = static_cast<off_t>(page_id) * page_size_;
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (offset > db_file_size_.load()) {
     LOG_DEBUG("I/O error while reading");
-    // std::cerr << "I/O error while reading" << std::endl;
   } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
+    size_t read_count = ReadFully(db_fd_, page_data, page_size_, offset);
+    // if file ends before reading a page
+    if (read_count < static_cast<size_t>(page_size_)) {
       LOG_DEBUG("Read less than a page");
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+      memset(page_data + read_count, 0, page_size_ - read_count);
     }
   }
 }
 
+/*
+ * The mapping is read-only and shared, so it sees every pwrite right away.
+ * It is kept until the disk manager is destroyed, switching back to PREAD
+ * only stops reads from using it
+ */
+void DiskManager::SetReadMode(ReadMode read_mode) {
+  if (read_mode == ReadMode::MMAP && db_map_ == nullptr && db_fd_ >= 0) {
+    void *map =
+        mmap(nullptr, MMAP_RESERVE_SIZE, PROT_READ, MAP_SHARED, db_fd_, 0);
+    if (map == MAP_FAILED) {
+      LOG_DEBUG("cannot map %s: %s", file_name_.c_str(), strerror(errno));
+    } else {
+      db_map_ = static_cast<char *>(map);
+    }
+  }
+  read_mode_ = db_map_ != nullptr ? read_mode : ReadMode::PREAD;
+}
+
+/*
+ * Only pages entirely inside the file: touching the mapping past the end of
+ * the file faults
+ */
+const char *DiskManager::GetPageView(page_id_t page_id) {
+  if (read_mode_ != ReadMode::MMAP || page_id < 0)
+    return nullptr;
+  uint64_t end = (static_cast<uint64_t>(page_id) + 1) * page_size_;
+  if (end > static_cast<uint64_t>(db_file_size_.load()) ||
+      end > MMAP_RESERVE_SIZE)
+    return nullptr;
+  return db_map_ + end - page_size_;
+}
+
+AsyncIO *DiskManager::GetAsyncIO() {
+  std::call_once(async_io_once_, [this] {
+    async_io_ = AsyncIO::Create(async_io_type_, db_fd_, ASYNC_IO_QUEUE_DEPTH);
+  });
+  return async_io_;
+}
+
+AsyncIOType DiskManager::GetAsyncIOType() { return GetAsyncIO()->GetType(); }
+
+std::future<bool> DiskManager::ReadPageAsync(page_id_t page_id,
+                                             char *page_data) {
+  return std::move(SubmitPageIO({{false, page_id, page_data, 1}})[0]);
+}
+
+std::future<bool> DiskManager::WritePageAsync(page_id_t page_id,
+                                              const char *page_data) {
+  return WritePagesAsync(page_id, page_data, 1);
+}
+
+std::future<bool> DiskManager::WritePagesAsync(page_id_t first_page_id,
+                                               const char *pages_data,
+                                               int num_pages) {
+  return std::move(SubmitPageIO({{true, first_page_id,
+                                  const_cast<char *>(pages_data),
+                                  num_pages}})[0]);
+}
+
+/*
+ * Writes raise the cached file size once they are done, like WritePages.
+ * Reads the mapping can serve are copied right away
+ */
+std::vector<std::future<bool>>
+DiskManager::SubmitPageIO(const std::vector<PageIORequest> &requests) {
+  std::vector<std::future<bool>> futures;
+  std::vector<AsyncIORequest *> batch;
+  for (const PageIORequest &page_io : requests) {
+    const char *mapped =
+        page_io.write_ ? nullptr : GetPageView(page_io.page_id_);
+    if (mapped != nullptr &&
+        GetPageView(page_io.page_id_ + page_io.num_pages_ - 1) != nullptr) {
+      memcpy(page_io.data_, mapped,
+             static_cast<size_t>(page_io.num_pages_) * page_size_);
+      std::promise<bool> done;
+      done.set_value(true);
+      futures.push_back(done.get_future());
+      continue;
+    }
+    AsyncIORequest *request = new AsyncIORequest;
+    request->write_ = page_io.write_;
+    request->data_ = page_io.data_;
+    request->size_ = static_cast<size_t>(page_io.num_pages_) * page_size_;
+    request->offset_ = static_cast<off_t>(page_io.page_id_) * page_size_;
+    if (page_io.write_) {
+      off_t offset = request->offset_;
+      request->on_complete_ = [this, offset](size_t done) {
+        ExtendFileSize(offset + done);
+      };
+    }
+    futures.push_back(request->promise_.get_future());
+    batch.push_back(request);
+  }
+  if (!batch.empty())
+    GetAsyncIO()->Submit(batch);
+  return futures;
+}
+
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
@@ -158,16 +321,30 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
 
 /**
  * Allocate new page (operations like create index/table)
- * For now just keep an increasing counter
+ * Freed pages are reused first, so the file only grows when none is left
+ * (or, for a page with a hint, no whole extent is)
  */
-page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
+page_id_t DiskManager::AllocatePage(page_id_t hint) {
+  return free_space_map_.Allocate(hint);
+}
 
 /**
  * Deallocate page (operations like drop index/table)
- * Need bitmap in header page for tracking pages
+ * The page is marked free in the free space map, its contents on disk are
+ * left as they are
+ */
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  if (!free_space_map_.Deallocate(page_id)) {
+    LOG_DEBUG("page %d is not allocated", page_id);
+  }
+}
+
+/**
+ * Pages past the end of the file have never been written, reading them
+ * returns nothing useful
  */
-void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-  return;
+page_id_t DiskManager::GetNumPages() {
+  return static_cast<page_id_t>(db_file_size_.load() / page_size_);
 }
 
 /**
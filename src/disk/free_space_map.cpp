@@ -0,0 +1,331 @@
+/**
+ * free_space_map.cpp
+ */
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common/logger.h"
+#include "disk/async_io.h"
+#include "disk/free_space_map.h"
+
+namespace cmudb {
+
+static const uint32_t MAP_MAGIC = 0x46534d31; // "FSM1"
+
+FreeSpaceMap::FreeSpaceMap()
+    : fd_(-1), words_per_page_(PAGE_SIZE / 8), num_free_(0),
+      next_page_id_(0), extents_enabled_(true), num_reserved_(0) {}
+
+FreeSpaceMap::~FreeSpaceMap() {
+  if (fd_ >= 0)
+    close(fd_);
+}
+
+/*
+ * Without a map file the map still works, it just does not survive the
+ * disk manager
+ */
+void FreeSpaceMap::Open(const std::string &file_name, int page_size,
+                        page_id_t num_pages, bool reset) {
+  std::lock_guard<std::mutex> guard(latch_);
+  words_per_page_ = page_size / 8;
+  map_.clear();
+  free_counts_.clear();
+  reserved_.clear();
+  num_free_ = 0;
+  num_reserved_ = 0;
+  next_page_id_ = reset ? 0 : num_pages;
+
+  fd_ = open(file_name.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0) {
+    LOG_DEBUG("cannot open %s: %s", file_name.c_str(), strerror(errno));
+    return;
+  }
+  struct stat stat_buf;
+  size_t num_map_pages = 0;
+  if (!reset && fstat(fd_, &stat_buf) == 0)
+    num_map_pages = stat_buf.st_size / page_size;
+  if (num_map_pages > 0) {
+    map_.resize(num_map_pages * words_per_page_);
+    size_t size = map_.size() * sizeof(uint64_t);
+    uint32_t magic = 0;
+    if (ReadFully(fd_, reinterpret_cast<char *>(map_.data()), size, 0) ==
+        size)
+      memcpy(&magic, map_.data(), 4);
+    if (magic == MAP_MAGIC) {
+      memcpy(&next_page_id_, reinterpret_cast<char *>(map_.data()) + 4, 4);
+      free_counts_.resize(num_map_pages);
+      for (size_t i = 0; i < num_map_pages; ++i) {
+        for (size_t j = 0; j < words_per_page_ - 1; ++j) {
+          free_counts_[i] += __builtin_popcountll(Bits(i)[j]);
+        }
+        num_free_ += free_counts_[i];
+      }
+      return;
+    }
+    // not a map, start over from the db file
+    LOG_DEBUG("rebuilding free space map %s", file_name.c_str());
+    map_.clear();
+  }
+
+  if (ftruncate(fd_, 0) != 0) {
+    LOG_DEBUG("cannot truncate %s: %s", file_name.c_str(), strerror(errno));
+  }
+  map_.resize(words_per_page_);
+  free_counts_.resize(1);
+  WriteMapPage(0);
+}
+
+page_id_t FreeSpaceMap::Allocate(page_id_t hint) {
+  std::lock_guard<std::mutex> guard(latch_);
+  page_id_t page_id = INVALID_PAGE_ID;
+  bool hinted = hint >= 0 && hint < next_page_id_;
+  if (hinted && extents_enabled_) {
+    page_id = FindInExtent(hint);
+    if (page_id == INVALID_PAGE_ID)
+      page_id = ReserveExtent(hint);
+  } else if (num_free_ > num_reserved_) {
+    if (hinted)
+      page_id = FindNear(hint);
+    if (page_id == INVALID_PAGE_ID)
+      page_id = FindLowest();
+  }
+
+  if (page_id == INVALID_PAGE_ID) {
+    page_id = next_page_id_++;
+    WriteMapPage(0);
+    return page_id;
+  }
+  SetFree(page_id, false);
+  WriteMapPage(page_id / PagesPerMapPage());
+  return page_id;
+}
+
+bool FreeSpaceMap::Deallocate(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (page_id < 0 || page_id >= next_page_id_ || IsFree(page_id))
+    return false;
+  SetFree(page_id, true);
+  WriteMapPage(page_id / PagesPerMapPage());
+  return true;
+}
+
+/*
+ * Turning extents off gives the reserved pages back to everyone
+ */
+void FreeSpaceMap::SetExtentAllocation(bool enabled) {
+  std::lock_guard<std::mutex> guard(latch_);
+  extents_enabled_ = enabled;
+  if (!enabled) {
+    reserved_.clear();
+    num_reserved_ = 0;
+  }
+}
+
+bool FreeSpaceMap::IsAllocated(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  return page_id >= 0 && page_id < next_page_id_ && !IsFree(page_id);
+}
+
+page_id_t FreeSpaceMap::GetNextPageId() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return next_page_id_;
+}
+
+size_t FreeSpaceMap::GetNumFreePages() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return num_free_;
+}
+
+bool FreeSpaceMap::IsFree(page_id_t page_id) {
+  size_t map_page = page_id / PagesPerMapPage();
+  size_t bit = page_id % PagesPerMapPage();
+  return map_page < free_counts_.size() &&
+         (Bits(map_page)[bit / 64] >> (bit % 64) & 1) != 0;
+}
+
+// make sure the map reaches map_page
+void FreeSpaceMap::AddMapPages(size_t map_page) {
+  if (map_page >= free_counts_.size()) {
+    map_.resize((map_page + 1) * words_per_page_);
+    free_counts_.resize(map_page + 1);
+  }
+}
+
+/*
+ * An allocated page is no longer reserved. The caller writes the map page
+ */
+void FreeSpaceMap::SetFree(page_id_t page_id, bool free) {
+  size_t map_page = page_id / PagesPerMapPage();
+  size_t bit = page_id % PagesPerMapPage();
+  AddMapPages(map_page);
+  uint64_t mask = uint64_t(1) << (bit % 64);
+  if (free) {
+    Bits(map_page)[bit / 64] |= mask;
+    free_counts_[map_page]++;
+    num_free_++;
+  } else {
+    Bits(map_page)[bit / 64] &= ~mask;
+    free_counts_[map_page]--;
+    num_free_--;
+    size_t extent = page_id / EXTENT_SIZE;
+    if ((Reserved(extent) & mask) != 0) {
+      reserved_[extent] &= ~mask;
+      num_reserved_--;
+    }
+  }
+}
+
+/*
+ * The first free page at or after hint in its word and the last one before
+ * it, whichever is nearer
+ */
+page_id_t FreeSpaceMap::FindInExtent(page_id_t hint) {
+  size_t map_page = hint / PagesPerMapPage();
+  if (map_page >= free_counts_.size() || free_counts_[map_page] == 0)
+    return INVALID_PAGE_ID;
+  size_t bit = hint % PagesPerMapPage();
+  uint64_t bits = Bits(map_page)[bit / 64];
+  size_t pos = bit % 64;
+  uint64_t after = bits & (~uint64_t(0) << pos);
+  uint64_t before = bits & ((uint64_t(1) << pos) - 1);
+  page_id_t first = hint - static_cast<page_id_t>(pos);
+  if (after != 0 &&
+      (before == 0 || static_cast<size_t>(__builtin_ctzll(after)) - pos <=
+                          pos - (63 - __builtin_clzll(before))))
+    return first + __builtin_ctzll(after);
+  if (before != 0)
+    return first + 63 - __builtin_clzll(before);
+  return INVALID_PAGE_ID;
+}
+
+/*
+ * The first free page at or after hint and the last one before it, word by
+ * word, whichever is nearer. Only used without extents, so nothing is
+ * reserved
+ */
+page_id_t FreeSpaceMap::FindNear(page_id_t hint) {
+  size_t map_page = hint / PagesPerMapPage();
+  if (map_page >= free_counts_.size() || free_counts_[map_page] == 0)
+    return INVALID_PAGE_ID;
+  const uint64_t *bits = Bits(map_page);
+  size_t num_words = words_per_page_ - 1;
+  size_t bit = hint % PagesPerMapPage();
+  size_t word = bit / 64;
+  long after = -1, before = -1;
+
+  for (size_t i = word; i < num_words; ++i) {
+    uint64_t rest = bits[i];
+    if (i == word)
+      rest &= ~uint64_t(0) << (bit % 64);
+    if (rest != 0) {
+      after = i * 64 + __builtin_ctzll(rest);
+      break;
+    }
+  }
+  for (size_t i = word + 1; i-- > 0;) {
+    uint64_t rest = bits[i];
+    if (i == word)
+      rest &= (uint64_t(1) << (bit % 64)) - 1;
+    if (rest != 0) {
+      before = i * 64 + 63 - __builtin_clzll(rest);
+      break;
+    }
+  }
+
+  long found = after;
+  if (after < 0 || (before >= 0 && static_cast<long>(bit) - before <
+                                       after - static_cast<long>(bit)))
+    found = before;
+  if (found < 0)
+    return INVALID_PAGE_ID;
+  return static_cast<page_id_t>(map_page * PagesPerMapPage() + found);
+}
+
+page_id_t FreeSpaceMap::FindLowest() {
+  for (size_t map_page = 0; map_page < free_counts_.size(); ++map_page) {
+    if (free_counts_[map_page] == 0)
+      continue;
+    const uint64_t *bits = Bits(map_page);
+    size_t num_words = words_per_page_ - 1;
+    for (size_t i = 0; i < num_words; ++i) {
+      uint64_t rest = bits[i] & ~Reserved(map_page * num_words + i);
+      if (rest != 0)
+        return static_cast<page_id_t>(map_page * PagesPerMapPage() + i * 64 +
+                                      __builtin_ctzll(rest));
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+/*
+ * The extent after hint's if it is entirely free, else the lowest such
+ * extent, else a new one at the end of the file; the pages skipped to align
+ * it become free
+ */
+page_id_t FreeSpaceMap::ReserveExtent(page_id_t hint) {
+  size_t num_words = words_per_page_ - 1;
+  auto is_free_extent = [this, num_words](size_t extent) {
+    size_t map_page = extent / num_words;
+    return map_page < free_counts_.size() &&
+           Bits(map_page)[extent % num_words] == ~uint64_t(0) &&
+           Reserved(extent) == 0;
+  };
+
+  size_t extent = hint / EXTENT_SIZE + 1;
+  bool found = is_free_extent(extent);
+  for (size_t map_page = 0; !found && map_page < free_counts_.size();
+       ++map_page) {
+    if (free_counts_[map_page] < EXTENT_SIZE)
+      continue;
+    for (size_t i = map_page * num_words; i < (map_page + 1) * num_words;
+         ++i) {
+      if (is_free_extent(i)) {
+        extent = i;
+        found = true;
+        break;
+      }
+    }
+  }
+
+  if (!found) {
+    extent = (next_page_id_ + EXTENT_SIZE - 1) / EXTENT_SIZE;
+    page_id_t old_next_page_id = next_page_id_;
+    next_page_id_ = static_cast<page_id_t>((extent + 1) * EXTENT_SIZE);
+    for (page_id_t page_id = old_next_page_id; page_id < next_page_id_;
+         ++page_id) {
+      SetFree(page_id, true);
+    }
+    size_t first_map_page = old_next_page_id / PagesPerMapPage();
+    if (first_map_page != 0)
+      WriteMapPage(0);
+    for (size_t map_page = first_map_page;
+         map_page <= (next_page_id_ - 1) / PagesPerMapPage(); ++map_page) {
+      WriteMapPage(map_page);
+    }
+  }
+
+  if (extent >= reserved_.size())
+    reserved_.resize(extent + 1);
+  reserved_[extent] = ~uint64_t(0);
+  num_reserved_ += EXTENT_SIZE;
+  return static_cast<page_id_t>(extent * EXTENT_SIZE);
+}
+
+void FreeSpaceMap::WriteMapPage(size_t map_page) {
+  char *data = reinterpret_cast<char *>(&map_[map_page * words_per_page_]);
+  memcpy(data, &MAP_MAGIC, 4);
+  if (map_page == 0)
+    memcpy(data + 4, &next_page_id_, 4);
+  if (fd_ < 0)
+    return;
+  size_t size = words_per_page_ * sizeof(uint64_t);
+  if (WriteFully(fd_, data, size, map_page * size) < size) {
+    LOG_DEBUG("I/O error while writing free space map");
+  }
+}
+
+} // namespace cmudb
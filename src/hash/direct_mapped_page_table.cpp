@@ -0,0 +1,155 @@
+/**
+ * direct_mapped_page_table.cpp
+ */
+
+#include <algorithm>
+
+#include "common/exception.h"
+#include "hash/direct_mapped_page_table.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+template <typename V>
+DirectMappedPageTable<V>::DirectMappedPageTable(size_t stride, size_t offset,
+                                                size_t expected_pages)
+    : stride_(stride == 0 ? 1 : stride), offset_(offset % stride_),
+      directory_(nullptr), size_(0) {
+  std::lock_guard<std::mutex> guard(mtx);
+  GrowDirectory(std::max<size_t>(
+      1, (expected_pages + leaf_size_ - 1) >> leaf_bits_));
+}
+
+template <typename V> DirectMappedPageTable<V>::~DirectMappedPageTable() {
+  Directory *directory = directory_.load();
+  for (size_t i = 0; i < directory->size; ++i)
+    delete directory->leaves[i].load();
+  old_directories_.push_back(directory);
+  for (Directory *old : old_directories_) {
+    delete[] old->leaves;
+    delete old;
+  }
+}
+
+template <typename V>
+bool DirectMappedPageTable<V>::GetIndex(page_id_t page_id,
+                                        size_t &index) const {
+  if (page_id < 0 || static_cast<size_t>(page_id) % stride_ != offset_)
+    return false;
+  index = static_cast<size_t>(page_id) / stride_;
+  return true;
+}
+
+/*
+ * The new directory shares the leaves of the old one, which stays allocated
+ * for the readers that loaded it before the switch
+ */
+template <typename V> void DirectMappedPageTable<V>::GrowDirectory(size_t size) {
+  Directory *old = directory_.load(std::memory_order_relaxed);
+  size_t new_size = old == nullptr ? 1 : old->size;
+  while (new_size < size)
+    new_size <<= 1;
+
+  Directory *directory = new Directory;
+  directory->size = new_size;
+  directory->leaves = new std::atomic<Leaf *>[new_size];
+  for (size_t i = 0; i < new_size; ++i) {
+    Leaf *leaf = nullptr;
+    if (old != nullptr && i < old->size)
+      leaf = old->leaves[i].load(std::memory_order_relaxed);
+    directory->leaves[i].store(leaf, std::memory_order_relaxed);
+  }
+  directory_.store(directory, std::memory_order_release);
+  if (old != nullptr)
+    old_directories_.push_back(old);
+}
+
+/*
+ * lookup function to find value associate with input key, without locking
+ */
+template <typename V>
+bool DirectMappedPageTable<V>::Find(const page_id_t &page_id, V &value) {
+  size_t index;
+  if (!GetIndex(page_id, index))
+    return false;
+  Directory *directory = directory_.load(std::memory_order_acquire);
+  if ((index >> leaf_bits_) >= directory->size)
+    return false;
+  Leaf *leaf =
+      directory->leaves[index >> leaf_bits_].load(std::memory_order_acquire);
+  if (leaf == nullptr)
+    return false;
+  V result = leaf->slots[index & (leaf_size_ - 1)].load(
+      std::memory_order_acquire);
+  if (result == V())
+    return false;
+  value = result;
+  return true;
+}
+
+/*
+ * delete <key,value> entry in hash table, the leaf stays allocated
+ */
+template <typename V>
+bool DirectMappedPageTable<V>::Remove(const page_id_t &page_id) {
+  size_t index;
+  if (!GetIndex(page_id, index))
+    return false;
+  std::lock_guard<std::mutex> guard(mtx);
+  Directory *directory = directory_.load(std::memory_order_relaxed);
+  if ((index >> leaf_bits_) >= directory->size)
+    return false;
+  Leaf *leaf =
+      directory->leaves[index >> leaf_bits_].load(std::memory_order_relaxed);
+  if (leaf == nullptr)
+    return false;
+  if (leaf->slots[index & (leaf_size_ - 1)].exchange(
+          V(), std::memory_order_release) == V())
+    return false;
+  size_--;
+  return true;
+}
+
+/*
+ * insert <key,value> entry in hash table, replacing the value if key is
+ * already there. Page ids this table does not hold throw
+ */
+template <typename V>
+void DirectMappedPageTable<V>::Insert(const page_id_t &page_id,
+                                      const V &value) {
+  size_t index;
+  if (!GetIndex(page_id, index) || value == V())
+    throw Exception(EXCEPTION_TYPE_OUT_OF_RANGE,
+                    "page id does not belong to page table");
+  std::lock_guard<std::mutex> guard(mtx);
+  Directory *directory = directory_.load(std::memory_order_relaxed);
+  if ((index >> leaf_bits_) >= directory->size) {
+    GrowDirectory((index >> leaf_bits_) + 1);
+    directory = directory_.load(std::memory_order_relaxed);
+  }
+  std::atomic<Leaf *> &entry = directory->leaves[index >> leaf_bits_];
+  Leaf *leaf = entry.load(std::memory_order_relaxed);
+  if (leaf == nullptr) {
+    leaf = new Leaf;
+    entry.store(leaf, std::memory_order_release);
+  }
+  if (leaf->slots[index & (leaf_size_ - 1)].exchange(
+          value, std::memory_order_release) == V())
+    size_++;
+}
+
+template <typename V> size_t DirectMappedPageTable<V>::Size() {
+  std::lock_guard<std::mutex> guard(mtx);
+  return size_;
+}
+
+template <typename V> size_t DirectMappedPageTable<V>::GetCapacity() {
+  std::lock_guard<std::mutex> guard(mtx);
+  return directory_.load(std::memory_order_relaxed)->size * leaf_size_ *
+         stride_;
+}
+
+template class DirectMappedPageTable<Page *>;
+// test purpose
+template class DirectMappedPageTable<int>;
+} // namespace cmudb
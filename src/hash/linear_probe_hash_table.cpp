@@ -0,0 +1,218 @@
+/**
+ * linear_probe_hash_table.cpp
+ */
+
+#include <functional>
+#include <thread>
+
+#include "common/exception.h"
+#include "hash/linear_probe_hash_table.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+template <typename K, typename V>
+LinearProbeHashTable<K, V>::LinearProbeHashTable(size_t max_size)
+    : slots_(NewSlotArray(max_size)), size_(0), version_(0) {}
+
+template <typename K, typename V>
+LinearProbeHashTable<K, V>::~LinearProbeHashTable() {
+  old_slots_.push_back(slots_.load());
+  for (SlotArray *array : old_slots_) {
+    delete[] array->slots;
+    delete array;
+  }
+}
+
+template <typename K, typename V>
+typename LinearProbeHashTable<K, V>::SlotArray *
+LinearProbeHashTable<K, V>::NewSlotArray(size_t max_size) {
+  SlotArray *array = new SlotArray;
+  array->capacity = 2;
+  array->shift = 63;
+  while (array->capacity < 2 * max_size) {
+    array->capacity <<= 1;
+    array->shift--;
+  }
+  array->mask = array->capacity - 1;
+  array->slots = new Slot[array->capacity];
+  return array;
+}
+
+/*
+ * Fibonacci hashing on top of std::hash, which is the identity for integers:
+ * page ids of one buffer pool instance are all congruent modulo the number
+ * of instances and would otherwise pile up in a few runs of slots
+ */
+template <typename K, typename V>
+size_t LinearProbeHashTable<K, V>::HashKey(const SlotArray *array,
+                                           const K &key) {
+  uint64_t hash = std::hash<K>()(key);
+  return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ULL) >> array->shift);
+}
+
+template <typename K, typename V>
+size_t LinearProbeHashTable<K, V>::FindSlot(const SlotArray *array,
+                                            const K &key) {
+  for (size_t i = HashKey(array, key), probes = 0; probes < array->capacity;
+       i = (i + 1) & array->mask, probes++) {
+    if (!array->slots[i].occupied.load(std::memory_order_relaxed))
+      break;
+    if (array->slots[i].key.load(std::memory_order_relaxed) == key)
+      return i;
+  }
+  return array->capacity;
+}
+
+template <typename K, typename V> void LinearProbeHashTable<K, V>::BeginWrite() {
+  version_.store(version_.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+template <typename K, typename V> void LinearProbeHashTable<K, V>::EndWrite() {
+  version_.store(version_.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_release);
+}
+
+/*
+ * lookup function to find value associate with input key, without locking.
+ * Retry whenever a writer was active during the probe
+ */
+template <typename K, typename V>
+bool LinearProbeHashTable<K, V>::Find(const K &key, V &value) {
+  while (true) {
+    size_t version = version_.load(std::memory_order_acquire);
+    if (version & 1) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    const SlotArray *array = slots_.load(std::memory_order_acquire);
+    bool found = false;
+    V result = V();
+    for (size_t i = HashKey(array, key), probes = 0; probes < array->capacity;
+         i = (i + 1) & array->mask, probes++) {
+      if (!array->slots[i].occupied.load(std::memory_order_relaxed))
+        break;
+      if (array->slots[i].key.load(std::memory_order_relaxed) == key) {
+        result = array->slots[i].value.load(std::memory_order_relaxed);
+        found = true;
+        break;
+      }
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (version_.load(std::memory_order_relaxed) == version) {
+      if (found)
+        value = result;
+      return found;
+    }
+  }
+}
+
+/*
+ * delete <key,value> entry in hash table. The entries after it in the same
+ * run are shifted back into the hole unless that would move them before
+ * their home slot
+ */
+template <typename K, typename V>
+bool LinearProbeHashTable<K, V>::Remove(const K &key) {
+  std::lock_guard<std::mutex> guard(mtx);
+
+  SlotArray *array = slots_.load(std::memory_order_relaxed);
+  Slot *slots = array->slots;
+  size_t mask = array->mask;
+  size_t hole = FindSlot(array, key);
+  if (hole == array->capacity)
+    return false;
+
+  BeginWrite();
+  for (size_t i = (hole + 1) & mask;
+       slots[i].occupied.load(std::memory_order_relaxed); i = (i + 1) & mask) {
+    K moved_key = slots[i].key.load(std::memory_order_relaxed);
+    // distance from the home slot, the entry may move back into the hole
+    // only if the hole is not further away than that
+    size_t home = HashKey(array, moved_key);
+    if (((i - home) & mask) >= ((i - hole) & mask)) {
+      slots[hole].key.store(moved_key, std::memory_order_relaxed);
+      slots[hole].value.store(slots[i].value.load(std::memory_order_relaxed),
+                              std::memory_order_relaxed);
+      hole = i;
+    }
+  }
+  slots[hole].occupied.store(false, std::memory_order_relaxed);
+  size_--;
+  EndWrite();
+  return true;
+}
+
+/*
+ * insert <key,value> entry in hash table, replacing the value if key is
+ * already there. The table only grows through Reserve: inserting more than
+ * max_size keys eventually throws
+ */
+template <typename K, typename V>
+void LinearProbeHashTable<K, V>::Insert(const K &key, const V &value) {
+  std::lock_guard<std::mutex> guard(mtx);
+
+  SlotArray *array = slots_.load(std::memory_order_relaxed);
+  size_t i = FindSlot(array, key);
+  if (i == array->capacity) {
+    if (size_ + 1 >= array->capacity)
+      throw Exception(EXCEPTION_TYPE_OUT_OF_RANGE, "hash table is full");
+    i = HashKey(array, key);
+    while (array->slots[i].occupied.load(std::memory_order_relaxed))
+      i = (i + 1) & array->mask;
+    size_++;
+  }
+
+  BeginWrite();
+  array->slots[i].key.store(key, std::memory_order_relaxed);
+  array->slots[i].value.store(value, std::memory_order_relaxed);
+  array->slots[i].occupied.store(true, std::memory_order_relaxed);
+  EndWrite();
+}
+
+/*
+ * Rehash into a slot array sized for max_size entries, unless the current
+ * one already is. The old array stays allocated for lookups still probing
+ * it, which retry once they notice the version change
+ */
+template <typename K, typename V>
+void LinearProbeHashTable<K, V>::Reserve(size_t max_size) {
+  std::lock_guard<std::mutex> guard(mtx);
+
+  SlotArray *old = slots_.load(std::memory_order_relaxed);
+  if (old->capacity >= 2 * max_size)
+    return;
+  SlotArray *array = NewSlotArray(max_size);
+  for (size_t j = 0; j < old->capacity; ++j) {
+    if (!old->slots[j].occupied.load(std::memory_order_relaxed))
+      continue;
+    K key = old->slots[j].key.load(std::memory_order_relaxed);
+    size_t i = HashKey(array, key);
+    while (array->slots[i].occupied.load(std::memory_order_relaxed))
+      i = (i + 1) & array->mask;
+    array->slots[i].key.store(key, std::memory_order_relaxed);
+    array->slots[i].value.store(
+        old->slots[j].value.load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    array->slots[i].occupied.store(true, std::memory_order_relaxed);
+  }
+
+  BeginWrite();
+  slots_.store(array, std::memory_order_release);
+  EndWrite();
+  old_slots_.push_back(old);
+}
+
+template <typename K, typename V> size_t LinearProbeHashTable<K, V>::Size() {
+  std::lock_guard<std::mutex> guard(mtx);
+  return size_;
+}
+
+template class LinearProbeHashTable<page_id_t, Page *>;
+// test purpose
+template class LinearProbeHashTable<int, int>;
+} // namespace cmudb
@@ -0,0 +1,94 @@
+/**
+ * arc_replacer.h
+ *
+ * Functionality: Adaptive Replacement Cache (Megiddo & Modha). Resident
+ * pages are split into T1 (referenced once since they were loaded) and T2
+ * (referenced again while resident). Pages evicted from T1/T2 leave their
+ * page id behind in the ghost lists B1/B2. A miss that hits B1 means T1 was
+ * too small, a miss that hits B2 means T2 was too small, and the target size
+ * p of T1 moves accordingly. Scans only ever fill T1, while pages that keep
+ * being referenced settle in T2, without any tuning knob.
+ *
+ * Ghost entries outlive the frames, so every list is keyed by page id rather
+ * than by frame. The ghost lists never hold more than capacity (the number
+ * of frames handed to the replacer) page ids together with the resident
+ * pages of the same side, and 2 * capacity in total.
+ *
+ * A replacer that shares the frames with others (shares_capacity, e.g. one
+ * level of a PriorityReplacer, each built with the whole pool as capacity)
+ * also keeps no more ghosts than it has resident pages. All of them
+ * together then remember at most capacity page ids besides the resident
+ * ones, as a single ARC over the full pool does, and the ghosts go to the
+ * levels in proportion to the frames they hold. Each one still adapts its
+ * own target p: the levels are separate orders, and a ghost hit only says
+ * something about the order it was evicted from.
+ */
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace cmudb {
+
+template <typename T> class ARCReplacer : public Replacer<T> {
+public:
+  explicit ARCReplacer(size_t capacity, bool shares_capacity = false);
+
+  ~ARCReplacer();
+
+  void Insert(const T &value);
+
+  bool Victim(T &value);
+
+  bool Erase(const T &value);
+
+  size_t Size();
+
+  void PeekVictims(std::vector<T> &values, size_t n);
+
+  // target size of T1, exposed for test
+  size_t GetTarget();
+  // page ids in B1 and B2, exposed for test
+  size_t GetNumGhosts();
+
+private:
+  enum ListId { T1 = 0, T2, B1, B2, NUM_LISTS };
+
+  struct Entry {
+    page_id_t key;
+    T value;        // meaningless for ghost entries
+    bool evictable; // only for resident entries
+  };
+
+  struct Position {
+    ListId list;
+    typename std::list<Entry>::iterator itr;
+  };
+
+  // move an entry to the MRU end of list
+  void MoveTo(const Position &pos, ListId list);
+  // drop the LRU ghosts until the lists are within their bounds
+  void TrimGhosts();
+  // drop the LRU ghost of B2, or of B1 if B2 is empty; false if both are
+  bool DropGhost();
+  // evict the LRU evictable entry of T1 or T2 into its ghost list
+  bool EvictFrom(ListId list, T &value);
+
+  std::mutex mtx;
+  const size_t capacity_;
+  const bool shares_capacity_;
+  size_t target_; // p, the target size of T1
+  size_t size_;   // number of evictable entries
+  std::list<Entry> lists_[NUM_LISTS]; // MRU at front
+  std::unordered_map<page_id_t, Position> index_;
+  // page id each resident value was last inserted with
+  std::unordered_map<T, page_id_t> resident_;
+};
+
+} // namespace cmudb
@@ -4,44 +4,316 @@
  * Functionality: The simplified Buffer Manager interface allows a client to
  * new/delete pages on disk, to read a disk page into the buffer pool and pin
  * it, also to unpin a page in the buffer pool.
+ * Frames are as large as the page size of the disk manager's database.
+ *
+ * The pool can be split into several independent instances, each owning its
+ * own frames, page table, replacer, free list and latch. A page always lives
+ * in the instance chosen by its page_id, so threads working on different
+ * pages rarely contend on the same latch.
+ *
+ * A page table hit pins the frame with an atomic increment and returns
+ * without taking the instance latch. The replacer finds out about hits
+ * through the frames' reference bits when it picks its next victim, and
+ * a frame stays in the replacer while it is pinned; eviction claims a
+ * frame by swapping its pin count from 0 to -1.
+ *
+ * Disk reads and writes are issued without holding the instance latch. The
+ * frame is marked io_in_progress_ meanwhile, so a cache hit never waits for
+ * somebody else's miss, and concurrent fetchers of a page that is still
+ * being read in wait on that frame instead of reading it twice.
+ *
+ * An optional background page cleaner writes out dirty, unpinned frames that
+ * are about to be evicted, so that foreground misses find clean victims and
+ * rarely pay for a write.
+ *
+ * Frames are allocated in chunks that never move (see frame_arena.h), so the
+ * pool can grow and shrink while it is in use (Resize). Shrinking retires
+ * frames instead of freeing them: their memory is handed back to the
+ * system, but the Page objects stay, so a stale pointer from a lock-free
+ * lookup is still safe to look at. The chunks can be backed by huge pages.
+ *
+ * PrefetchPages queues pages to be read in by a background thread, so a
+ * sequential scan can keep several reads ahead of the page it is on.
+ *
+ * Fetches can carry an access strategy. BULK_READ misses of large scans
+ * recycle a small ring of frames per instance, and those frames are never
+ * handed to the replacer, so a scan does not flush the working set of
+ * everybody else out of the pool.
+ *
+ * The pool can remember which pages were resident when it was shut down and
+ * read them back in the background after a restart (EnableWarmUp), so it
+ * does not start cold.
+ *
+ * Pages can be tagged with a retention priority (see PagePriority) when
+ * they are fetched, unpinned or created. A pool built with use_priorities
+ * orders the frames of each priority with its replacement policy
+ * separately in every instance and evicts from the lowest priority first,
+ * so heap traffic does not push index pages out. A page keeps its priority
+ * while it is resident. Without it the tags are recorded but ignored.
+ *
+ * Every instance counts hits, misses, evictions, writes, latch waits and I/O
+ * latencies into a shared BufferPoolStats (see buffer_pool_stats.h).
  */
 
 #pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <list>
 #include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
 
+#include "buffer/arc_replacer.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/priority_replacer.h"
 #include "disk/disk_manager.h"
-#include "hash/extendible_hash.h"
+#include "hash/direct_mapped_page_table.h"
+#include "hash/linear_probe_hash_table.h"
 #include "logging/log_manager.h"
 #include "page/page.h"
 
 namespace cmudb {
+// how the caller is going to use the page it fetches
+enum class AccessStrategy {
+  NORMAL = 0,
+  BULK_READ, // large sequential scan, every page is read once
+};
+
+// how far the warm-up of a restarted buffer pool got
+struct WarmUpProgress {
+  size_t total_ = 0;   // pages to warm up, known once the file was read
+  size_t loaded_ = 0;  // pages read in
+  size_t skipped_ = 0; // already resident, or no free frame left for them
+  bool running_ = false;
+};
+
 class BufferPoolManager {
 public:
   BufferPoolManager(size_t pool_size, DiskManager *disk_manager,
-                          LogManager *log_manager = nullptr);
+                    LogManager *log_manager = nullptr,
+                    size_t num_instances = 1,
+                    ReplacerType replacer_type = ReplacerType::LRU,
+                    PageTableType page_table_type =
+                        PageTableType::LINEAR_PROBE,
+                    HugePageMode huge_page_mode = HugePageMode::NONE,
+                    bool use_priorities = false);
 
   ~BufferPoolManager();
 
-  Page *FetchPage(page_id_t page_id);
+  Page *FetchPage(page_id_t page_id,
+                  AccessStrategy strategy = AccessStrategy::NORMAL);
+  // fetch and tag the page with priority
+  Page *FetchPage(page_id_t page_id, PagePriority priority,
+                  AccessStrategy strategy = AccessStrategy::NORMAL);
+
+  // resident page for an optimistic read, neither pinned nor latched, see
+  // Page::RValidate
+  Page *FetchPageOptimistic(page_id_t page_id, uint64_t &version);
 
   bool UnpinPage(page_id_t page_id, bool is_dirty);
+  // unpin and tag the page with priority
+  bool UnpinPage(page_id_t page_id, bool is_dirty, PagePriority priority);
+
+  // tag a page the caller pinned or reads optimistically with priority
+  inline void SetPagePriority(Page *page, PagePriority priority) {
+    // a descent retags the same pages over and over, keep their cache lines
+    // shared
+    if (page->priority_.load(std::memory_order_relaxed) != priority)
+      page->priority_.store(priority, std::memory_order_relaxed);
+  }
 
   bool FlushPage(page_id_t page_id);
 
-  Page *NewPage(page_id_t &page_id);
+  // write every dirty page, for checkpoints and shutdown; the caller must
+  // not hold any page latch
+  size_t FlushAllPages();
+
+  // hint: the page the new one is linked from, the disk manager keeps them
+  // in the same extent
+  Page *NewPage(page_id_t &page_id,
+                PagePriority priority = PagePriority::HEAP,
+                page_id_t hint = INVALID_PAGE_ID);
 
   bool DeletePage(page_id_t page_id);
 
+  // read count pages starting at first_page_id into the pool in the
+  // background, without pinning them
+  void PrefetchPages(page_id_t first_page_id, size_t count,
+                     AccessStrategy strategy = AccessStrategy::NORMAL);
+
+  // save the resident pages to file_name when the pool is destroyed, and
+  // start warming up with the pages a previous pool saved there
+  void EnableWarmUp(const std::string &file_name);
+  // write the ids of the resident pages to file_name, the ones the replacer
+  // would keep longest first; returns how many, 0 on error
+  size_t SaveResidentPages(const std::string &file_name);
+  // read the pages listed in file_name into free frames in the background,
+  // in page id order; does nothing while a warm-up is running
+  void WarmUp(const std::string &file_name);
+  void StopWarmUp();
+  WarmUpProgress GetWarmUpProgress() const;
+
+  // spawn a thread that keeps the clean_target next victims of every
+  // instance clean, waking up every interval or when a miss had to write
+  void RunPageCleanerThread(
+      size_t clean_target,
+      std::chrono::milliseconds interval = std::chrono::milliseconds(10));
+  void StopPageCleanerThread();
+
+  // statistics since the pool was created; the Delta of two snapshots is
+  // the activity in between
+  BufferPoolStatsSnapshot GetStats() const;
+  void DumpStats(std::ostream &os) const;
+  // spawn a thread that dumps the activity of the last interval to os every
+  // interval, os must outlive the thread
+  void RunStatsThread(std::chrono::milliseconds interval, std::ostream &os);
+  void StopStatsThread();
+
+  // dirty page writes paid by callers (evictions, FlushPage) and by the
+  // page cleaner
+  inline size_t GetNumForegroundWrites() const {
+    BufferPoolStatsSnapshot stats = GetStats();
+    return stats.Get(BufferPoolCounter::WRITE_BACK) +
+           stats.Get(BufferPoolCounter::FLUSH);
+  }
+  inline size_t GetNumBackgroundWrites() const {
+    return GetStats().Get(BufferPoolCounter::BACKGROUND_WRITE);
+  }
+  // pages read in by PrefetchPages
+  inline size_t GetNumPrefetchedPages() const {
+    return GetStats().Get(BufferPoolCounter::PREFETCH);
+  }
+
+  // grow or shrink the pool to pool_size frames (at least one per instance)
+  // while it is in use, returns the new size. Shrinking evicts unpinned
+  // pages, writing out dirty ones, but keeps pinned frames, so the pool may
+  // stay larger than asked for
+  size_t Resize(size_t pool_size);
+
+  // number of frames in service
+  inline size_t GetPoolSize() const { return pool_size_; }
+  inline size_t GetPageSize() const { return page_size_; }
+  inline size_t GetNumInstances() const { return num_instances_; }
+  // memory the initial frames came from, HUGETLB may have fallen back
+  HugePageMode GetHugePageMode() const;
+
 private:
-  size_t pool_size_; // number of pages in buffer pool
-  Page *pages_;      // array of pages
+
+  // one independent slice of the buffer pool
+  struct BufferPoolInstance {
+    size_t pool_size_;                         // number of frames in service
+    // frames allocated together, never moved or freed before the pool is
+    // destroyed
+    std::vector<FrameArena *> chunks_;
+    // every frame of the chunks in order, retired ones included
+    std::vector<Page *> frames_;
+    HashTable<page_id_t, Page *> *page_table_; // to keep track of pages
+    Replacer<Page *> *replacer_;   // to find an unpinned page for replacement
+    std::list<Page *> *free_list_; // to find a free page for replacement
+    std::mutex latch_;             // to protect shared data structure
+    // signalled whenever a frame finishes its I/O
+    std::condition_variable io_cv_;
+    // evicted dirty pages whose write back has not finished yet
+    std::unordered_set<page_id_t> write_back_set_;
+    // frames of bulk reads, oldest first
+    std::deque<Page *> ring_;
+    size_t ring_capacity_;
+    // frames with a pin count above 0, and the most there ever were
+    std::atomic<size_t> pinned_frames_{0};
+    std::atomic<size_t> max_pinned_frames_{0};
+  };
+
+  // replacer used by one instance holding at most pool_size frames
+  static Replacer<Page *> *CreateReplacer(ReplacerType replacer_type,
+                                         size_t pool_size,
+                                         bool use_priorities);
+  // page table of the instance_index-th instance, which holds pool_size
+  // frames to start with
+  HashTable<page_id_t, Page *> *CreatePageTable(PageTableType page_table_type,
+                                                size_t instance_index,
+                                                size_t pool_size);
+  BufferPoolInstance &GetInstance(page_id_t page_id);
+  void AddFrames(BufferPoolInstance &instance, size_t count);
+  size_t RetireFrames(BufferPoolInstance &instance,
+                      std::unique_lock<std::mutex> &lock, size_t count);
+  void UpdateRingCapacity(BufferPoolInstance &instance);
+  // no frame of chunk is in service
+  static bool AllRetired(FrameArena *chunk);
+  void AcquireLatch(std::unique_lock<std::mutex> &lock);
+  void ReadFromDisk(page_id_t page_id, char *page_data);
+  void WriteToDisk(page_id_t page_id, const char *page_data,
+                   int num_pages = 1);
+  void DoPageIO(const std::vector<PageIORequest> &requests);
+  Page *GetVictimPage(BufferPoolInstance &instance, page_id_t &dirty_page_id,
+                      AccessStrategy strategy = AccessStrategy::NORMAL);
+  static bool TryEvict(Page *page);
+  static void CountPin(BufferPoolInstance &instance);
+  static void CountUnpin(BufferPoolInstance &instance);
+  bool TryPin(BufferPoolInstance &instance, Page *page, page_id_t page_id);
+  Page *NextReplacerVictim(BufferPoolInstance &instance);
+  bool WaitForFlush(BufferPoolInstance &instance,
+                    std::unique_lock<std::mutex> &lock);
+  Page *RecycleRingFrame(BufferPoolInstance &instance);
+  void LeaveRing(BufferPoolInstance &instance, Page *page);
+  void ReleaseFrame(BufferPoolInstance &instance, Page *page);
+  void FinishIO(BufferPoolInstance &instance, Page *page,
+                page_id_t dirty_page_id);
+  void PageCleanerLoop();
+  void CleanInstance(BufferPoolInstance &instance);
+  void PrefetchLoop();
+  size_t PrefetchBatch(
+      const std::vector<std::pair<page_id_t, AccessStrategy>> &requests,
+      bool free_frame_only = false);
+  void WarmUpLoop(std::string file_name);
+  void StatsLoop(std::chrono::milliseconds interval, std::ostream &os);
+
+  std::atomic<size_t> pool_size_; // number of pages in buffer pool
+  size_t page_size_;              // size of a page in byte
+  size_t num_instances_;          // number of independent instances
+  HugePageMode huge_page_mode_;   // requested for new chunks of frames
+  std::mutex resize_latch_;       // one Resize at a time
+  BufferPoolInstance *instances_;
   DiskManager *disk_manager_;
   LogManager *log_manager_;
-  HashTable<page_id_t, Page *> *page_table_; // to keep track of pages
-  Replacer<Page *> *replacer_;   // to find an unpinned page for replacement
-  std::list<Page *> *free_list_; // to find a free page for replacement
-  std::mutex latch_;             // to protect shared data structure
+
+  // background page cleaner
+  std::thread *page_cleaner_thread_;
+  std::mutex page_cleaner_latch_;
+  std::condition_variable page_cleaner_cv_;
+  bool page_cleaner_running_;
+  size_t page_cleaner_target_;
+  std::chrono::milliseconds page_cleaner_interval_;
+
+  // read-ahead
+  std::thread *prefetch_thread_;
+  std::mutex prefetch_latch_;
+  std::condition_variable prefetch_cv_;
+  bool prefetch_running_;
+  std::deque<std::pair<page_id_t, AccessStrategy>> prefetch_queue_;
+
+  // warm-up after a restart
+  std::string warm_up_file_; // where resident pages are saved on shutdown
+  std::thread *warm_up_thread_;
+  std::mutex warm_up_latch_;
+  std::atomic<bool> warm_up_running_;
+  std::atomic<bool> warm_up_stop_;
+  std::atomic<size_t> warm_up_total_;
+  std::atomic<size_t> warm_up_loaded_;
+  std::atomic<size_t> warm_up_skipped_;
+
+  BufferPoolStats stats_;
+  std::thread *stats_thread_;
+  std::mutex stats_latch_;
+  std::condition_variable stats_cv_;
+  bool stats_running_;
 };
 } // namespace cmudb
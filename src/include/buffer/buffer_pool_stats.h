@@ -0,0 +1,107 @@
+/**
+ * buffer_pool_stats.h
+ *
+ * Statistics of a buffer pool. Counters are sharded: every thread updates
+ * the shard it was assigned on first use with relaxed atomic adds, so
+ * threads rarely share a cache line and the counters can stay enabled all
+ * the time. A snapshot adds the shards up; the difference of two snapshots
+ * gives the activity of the interval between them.
+ *
+ * I/O latencies are kept in histograms whose bucket i counts the operations
+ * that took less than 2^i microseconds (and at least 2^(i-1)).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace cmudb {
+
+enum class BufferPoolCounter {
+  FETCH_HIT = 0,
+  FETCH_MISS,
+  EVICTION,
+  WRITE_BACK,           // dirty victims written out by the evicting thread
+  BACKGROUND_WRITE,     // dirty pages written by the page cleaner
+  FLUSH,                // pages written by FlushPage and FlushAllPages
+  NEW_PAGE,
+  DELETE_PAGE,
+  PREFETCH,             // pages read in by read-ahead
+  WARM_UP,              // pages read in by the warm-up after a restart
+  LATCH_WAIT,           // instance latch acquisitions that had to block
+  LATCH_WAIT_NS,        // time spent blocked on instance latches
+  NUM_COUNTERS
+};
+
+std::string BufferPoolCounterToString(BufferPoolCounter counter);
+
+#define STATS_NUM_SHARDS 16     // threads are spread over this many shards
+#define STATS_LATENCY_BUCKETS 24 // up to 2^23 us (~8s), slower ones go last
+
+struct LatencyHistogram {
+  uint64_t buckets_[STATS_LATENCY_BUCKETS] = {};
+
+  uint64_t Count() const;
+  // upper bound in microseconds of the bucket holding the given percentile
+  uint64_t Percentile(double percentile) const;
+  LatencyHistogram &operator-=(const LatencyHistogram &other);
+};
+
+// point in time totals of a BufferPoolStats
+struct BufferPoolStatsSnapshot {
+  uint64_t counters_[static_cast<int>(BufferPoolCounter::NUM_COUNTERS)] = {};
+  LatencyHistogram read_latency_;
+  LatencyHistogram write_latency_;
+  // set by the pool: frames pinned now, the sum of every instance's
+  // high-water mark since construction (the pool's own mark is at most
+  // that) and frames in service
+  size_t pinned_frames_ = 0;
+  size_t max_pinned_frames_ = 0;
+  size_t pool_size_ = 0;
+  std::chrono::steady_clock::time_point time_;
+
+  inline uint64_t Get(BufferPoolCounter counter) const {
+    return counters_[static_cast<int>(counter)];
+  }
+  // fetch hits over fetches, 0 if there was no fetch
+  double HitRatio() const;
+  // activity between since and this snapshot, pinned frames and the pool
+  // size stay as they are
+  BufferPoolStatsSnapshot Delta(const BufferPoolStatsSnapshot &since) const;
+  void Dump(std::ostream &os) const;
+};
+
+class BufferPoolStats {
+public:
+  BufferPoolStats();
+
+  inline void Add(BufferPoolCounter counter, uint64_t value = 1) {
+    GetShard().counters_[static_cast<int>(counter)].fetch_add(
+        value, std::memory_order_relaxed);
+  }
+  void RecordReadLatency(std::chrono::steady_clock::duration latency);
+  void RecordWriteLatency(std::chrono::steady_clock::duration latency);
+
+  BufferPoolStatsSnapshot GetSnapshot() const;
+
+private:
+  // padded rather than aligned, the pool is allocated with plain new
+  struct Shard {
+    std::atomic<uint64_t>
+        counters_[static_cast<int>(BufferPoolCounter::NUM_COUNTERS)];
+    std::atomic<uint64_t> read_latency_[STATS_LATENCY_BUCKETS];
+    std::atomic<uint64_t> write_latency_[STATS_LATENCY_BUCKETS];
+    char padding_[64]; // keeps the next shard off our last cache line
+  };
+
+  Shard &GetShard();
+  static size_t LatencyBucket(std::chrono::steady_clock::duration latency);
+
+  Shard shards_[STATS_NUM_SHARDS];
+};
+
+} // namespace cmudb
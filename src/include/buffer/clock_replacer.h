@@ -0,0 +1,86 @@
+/**
+ * clock_replacer.h
+ *
+ * Functionality: CLOCK (second chance) approximation of LRU. Every frame
+ * owns a slot on a circular array, indexed by its frame id, with an
+ * evictable flag and a reference bit. Insert only sets the bit, and Victim
+ * sweeps a hand over the slots, clearing bits until it finds an evictable
+ * slot whose bit is already clear. Compared to LRUReplacer no list node is
+ * moved on Insert/Erase, and the cost of ordering is paid (amortized) by
+ * Victim.
+ *
+ * Insert and Erase only touch the slot's atomics and never take the latch;
+ * Victim and PeekVictims serialize on it to move the hand. The slots live in
+ * chunks that are never moved or freed, found through a directory that is
+ * replaced (the old one kept) when a frame id beyond it shows up, so the
+ * latch is only taken the first time a chunk of frame ids is seen.
+ * Values are placed by ClockSlot: a Page goes to its frame id, an int (for
+ * test) is its own slot.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "buffer/replacer.h"
+
+namespace cmudb {
+
+template <typename T> class ClockReplacer : public Replacer<T> {
+public:
+  ClockReplacer();
+
+  ~ClockReplacer();
+
+  void Insert(const T &value);
+
+  bool Victim(T &value);
+
+  bool Erase(const T &value);
+
+  size_t Size();
+
+  void PeekVictims(std::vector<T> &values, size_t n);
+
+private:
+  static const size_t CHUNK_SLOTS = 1024;
+
+  struct Chunk {
+    Chunk();
+    std::atomic<T> values[CHUNK_SLOTS];
+    std::atomic<bool> evictable[CHUNK_SLOTS]; // value is in the replacer
+    std::atomic<bool> ref[CHUNK_SLOTS]; // referenced since the hand passed
+  };
+
+  struct Directory {
+    explicit Directory(size_t size);
+    size_t size;
+    std::unique_ptr<std::atomic<Chunk *>[]> chunks;
+  };
+
+  // chunk of slot, nullptr if no value of it was ever inserted
+  inline Chunk *FindChunk(size_t slot) const {
+    Directory *directory = directory_.load(std::memory_order_acquire);
+    size_t index = slot / CHUNK_SLOTS;
+    if (index >= directory->size)
+      return nullptr;
+    return directory->chunks[index].load(std::memory_order_acquire);
+  }
+  Chunk *AddChunk(size_t slot);
+
+  std::mutex mtx;
+  std::atomic<Directory *> directory_;
+  // every directory ever published, a lock-free lookup may still read an
+  // old one
+  std::vector<std::unique_ptr<Directory>> directories_;
+  std::vector<std::unique_ptr<Chunk>> chunks_;
+  // one past the highest slot ever inserted, the hand sweeps below it
+  std::atomic<size_t> num_slots_;
+  std::atomic<size_t> size_;
+  size_t hand_;
+};
+
+} // namespace cmudb
@@ -0,0 +1,83 @@
+/**
+ * frame_arena.h
+ *
+ * Functionality: One allocation holding a run of buffer pool frames. The
+ * page data of all frames comes first, frame after frame, starting at the
+ * beginning of the mapping, which is aligned to the page size even when
+ * that is larger than the system's, so every data area is aligned to the
+ * page size (as direct I/O wants) and never shares a cache line with
+ * bookkeeping. The
+ * Page descriptors follow from the next page of memory on, each padded to a
+ * cache line of its own, so that pinning one frame does not bounce the line
+ * of its neighbours.
+ *
+ * The arena can be backed by huge pages, which cuts the TLB misses of
+ * touching many frames: TRANSPARENT asks the kernel to back the mapping with
+ * transparent huge pages, HUGETLB maps it from the reserved huge page pool
+ * and falls back to TRANSPARENT when there is none. Other platforms use the
+ * heap and ignore the mode.
+ *
+ * Frames never move. ReleaseData hands the memory of the page data back to
+ * the system while the mapping, the descriptors and any stale pointer into
+ * them stay valid; the data reads back as zeros.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "page/page.h"
+
+namespace cmudb {
+
+// memory the frames of a buffer pool are allocated from
+enum class HugePageMode { NONE = 0, TRANSPARENT, HUGETLB };
+
+inline std::string HugePageModeToString(HugePageMode huge_page_mode) {
+  switch (huge_page_mode) {
+  case HugePageMode::NONE:
+    return "NONE";
+  case HugePageMode::TRANSPARENT:
+    return "TRANSPARENT";
+  case HugePageMode::HUGETLB:
+    return "HUGETLB";
+  }
+  return "INVALID";
+}
+
+class FrameArena {
+public:
+  FrameArena(size_t num_frames, size_t page_size,
+             HugePageMode huge_page_mode = HugePageMode::NONE);
+  ~FrameArena();
+
+  inline Page *GetPage(size_t i) {
+    return reinterpret_cast<Page *>(memory_ + data_size_ + i * stride_);
+  }
+  inline size_t Size() const { return num_frames_; }
+  // mode the arena actually got, HUGETLB may have fallen back
+  inline HugePageMode GetHugePageMode() const { return huge_page_mode_; }
+
+  // drop the page data of every frame, until it is written again
+  void ReleaseData();
+  // some frames are in use again after ReleaseData
+  inline void ReuseData() { released_ = false; }
+  inline bool IsReleased() const { return released_; }
+
+private:
+  void Allocate();
+
+  size_t num_frames_;
+  size_t page_size_;
+  // page data of all frames in byte, rounded up to whole pages of memory so
+  // that releasing it leaves the descriptors alone
+  size_t data_size_;
+  size_t stride_;      // distance between descriptors, whole cache lines
+  size_t memory_size_; // whole allocation, in byte
+  HugePageMode huge_page_mode_;
+  char *memory_;
+  bool released_;
+};
+
+} // namespace cmudb
@@ -0,0 +1,83 @@
+/**
+ * lru_k_replacer.h
+ *
+ * Functionality: LRU-K replacement (O'Neil et al.). The replacer remembers
+ * the timestamps of the last K references of every frame and evicts the
+ * frame whose K-th most recent reference is the oldest. Frames referenced
+ * fewer than K times have an infinite backward K-distance and are evicted
+ * first, least recently used first, so a sequential scan that touches each
+ * page once cannot push out pages that are referenced over and over.
+ *
+ * A reference is counted each time a value is inserted (i.e. unpinned by the
+ * buffer pool). References that fall within correlated_period ticks of the
+ * previous one are treated as one correlated burst: they refresh the last
+ * timestamp instead of adding a new one, and a frame still inside its burst
+ * is only evicted if nothing else can be.
+ *
+ * Frames outside their burst and frames still inside it are kept in two
+ * ordered sets, and a queue of recent references moves frames from the
+ * second to the first as their bursts end, so every operation is O(log n)
+ * amortized with or without a correlated period.
+ */
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+
+namespace cmudb {
+
+template <typename T> class LRUKReplacer : public Replacer<T> {
+public:
+  explicit LRUKReplacer(size_t k = 2, size_t correlated_period = 0);
+
+  ~LRUKReplacer();
+
+  void Insert(const T &value);
+
+  bool Victim(T &value);
+
+  bool Erase(const T &value);
+
+  size_t Size();
+
+  void PeekVictims(std::vector<T> &values, size_t n);
+
+private:
+  // <has K references, timestamp used for ordering>
+  typedef std::pair<bool, size_t> Key;
+
+  struct Entry {
+    std::vector<size_t> history; // most recent first, at most K entries
+    bool evictable = false;
+    bool correlated = false; // in correlated_ rather than order_
+    typename std::set<std::pair<Key, T>>::iterator pos;
+  };
+
+  Key GetKey(const Entry &entry) const;
+  // move the values whose correlated period is over into order_
+  void EndBursts();
+  // take value out of whichever set it is in
+  void Unlink(Entry &entry);
+
+  std::mutex mtx;
+  const size_t k_;
+  const size_t correlated_period_;
+  size_t current_timestamp_;
+  std::unordered_map<T, Entry> entries_;
+  // evictable values outside their correlated period, in eviction order
+  std::set<std::pair<Key, T>> order_;
+  // evictable values still inside it, in eviction order
+  std::set<std::pair<Key, T>> correlated_;
+  // last references that may still be inside their correlated period,
+  // oldest first; those of values referenced again since are stale
+  std::deque<std::pair<size_t, T>> bursts_;
+};
+
+} // namespace cmudb
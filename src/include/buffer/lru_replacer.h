@@ -11,6 +11,7 @@
 
 #include <unordered_map>
 #include <list>
+#include <vector>
 #include "buffer/replacer.h"
 #include "hash/extendible_hash.h"
 
@@ -31,6 +32,8 @@ public:
 
   size_t Size();
 
+  void PeekVictims(std::vector<T> &values, size_t n);
+
 private:
 
   // add your member variables here
@@ -0,0 +1,62 @@
+/**
+ * priority_replacer.h
+ *
+ * Functionality: Replacer that honours retention priorities on top of any
+ * replacement policy. Every priority has its own replacer, and victims come
+ * from the lowest priority that has one, so e.g. heap and scan traffic only
+ * evicts index pages once there is nothing else left to evict. Within a
+ * priority the underlying policy decides.
+ *
+ * There is no latch of its own: Insert and Erase go straight to the
+ * replacer of the value's level, and Victim asks the levels in turn, so
+ * the replacers' own synchronization is all there is. A page records the
+ * level it is in itself (Page::replacer_priority_), ints (for test) in a
+ * map that is not thread safe. Insert, Erase and Victim must not race on
+ * the same value, which the buffer pool ensures by holding the instance
+ * latch.
+ */
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+
+namespace cmudb {
+
+template <typename T> class PriorityReplacer : public Replacer<T> {
+public:
+  // takes ownership of levels, one replacer per priority from SCAN up
+  explicit PriorityReplacer(const std::vector<Replacer<T> *> &levels);
+
+  ~PriorityReplacer();
+
+  // a page goes in with its own priority, an int keeps the priority it has
+  // in the replacer, a new one is HEAP
+  void Insert(const T &value);
+
+  void Insert(const T &value, PagePriority priority);
+
+  bool Victim(T &value);
+
+  bool Erase(const T &value);
+
+  size_t Size();
+
+  // values of the given priority
+  size_t Size(PagePriority priority);
+
+  void PeekVictims(std::vector<T> &values, size_t n);
+
+private:
+  // the level value is in, NUM_PRIORITIES if it is not in the replacer
+  PagePriority GetLevel(const T &value);
+  void SetLevel(const T &value, PagePriority level);
+
+  std::vector<Replacer<T> *> levels_;
+  // test only, the level of every int in the replacer
+  std::unordered_map<T, PagePriority> int_levels_;
+};
+
+} // namespace cmudb
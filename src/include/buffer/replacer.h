@@ -6,17 +6,47 @@
 #pragma once
 
 #include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
 
 namespace cmudb {
 
+// replacement policies a BufferPoolManager can be built with
+enum class ReplacerType { LRU = 0, CLOCK, LRU_K, ARC };
+
+inline std::string ReplacerTypeToString(ReplacerType replacer_type) {
+  switch (replacer_type) {
+  case ReplacerType::LRU:
+    return "LRU";
+  case ReplacerType::CLOCK:
+    return "CLOCK";
+  case ReplacerType::LRU_K:
+    return "LRU_K";
+  case ReplacerType::ARC:
+    return "ARC";
+  }
+  return "INVALID";
+}
+
 template <typename T> class Replacer {
 public:
   Replacer() {}
   virtual ~Replacer() {}
   virtual void Insert(const T &value) = 0;
+  // insert with a retention priority; a replacer that keeps a single order
+  // ignores it
+  virtual void Insert(const T &value, PagePriority priority) {
+    (void)priority;
+    Insert(value);
+  }
   virtual bool Victim(T &value) = 0;
   virtual bool Erase(const T &value) = 0;
   virtual size_t Size() = 0;
+  // append up to n values in the order Victim would return them, without
+  // removing them (used by the background page cleaner)
+  virtual void PeekVictims(std::vector<T> &values, size_t n) = 0;
 };
 
 } // namespace cmudb
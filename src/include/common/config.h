@@ -20,14 +20,37 @@ extern std::atomic<bool> ENABLE_LOGGING;
 #define INVALID_TXN_ID -1  // representing an invalid txn id
 #define INVALID_LSN -1     // representing an invalid lsn
 #define HEADER_PAGE_ID 0   // the header page id
-#define PAGE_SIZE 512     // size of a data page in byte
+#define PAGE_SIZE 512      // default size of a data page in byte
+#define MIN_PAGE_SIZE 512  // page sizes are powers of two in this range
+#define MAX_PAGE_SIZE 65536
 #define LOG_BUFFER_SIZE                                                            \
-  ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE) // size of a log buffer in byte
+  ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE) // default size of a log buffer in byte
 #define BUCKET_SIZE 50                 // size of extendible hash bucket
-#define BUFFER_POOL_SIZE 10            // size of buffer pool
+#define BUFFER_POOL_SIZE 10            // default size of buffer pool
+#define LRUK_REPLACER_K 2              // K of the LRU-K replacer
+#define LRUK_CORRELATED_PERIOD 0       // LRU-K correlated period in unpins
+#define READ_AHEAD_PAGES 8             // pages a sequential scan reads ahead
+#define SCAN_RING_SIZE 32              // frames bulk reads cycle through
+#define FLUSH_RUN_PAGES 64             // most pages a flush writes at once
+#define CACHELINE_SIZE 64              // frame descriptors are padded to it
+#define HUGE_PAGE_SIZE 2097152         // 2MB huge pages for frame memory
+#define ASYNC_IO_QUEUE_DEPTH 64        // asynchronous I/Os in flight at most
+#define ASYNC_IO_THREADS 4             // threads of the fallback backend
+#define EXTENT_SIZE 64                 // pages set aside for one table at once
+#define MMAP_RESERVE_SIZE (1ULL << 40) // address space mapped for the db file
 
 typedef int32_t page_id_t; // page id type
 typedef int32_t txn_id_t;  // transaction id type
 typedef int32_t lsn_t;     // log sequence number type
 
+// how long a page should stay in the buffer pool compared to the others,
+// pages of a lower priority are evicted first
+enum class PagePriority {
+  SCAN = 0, // read once by a scan
+  HEAP,     // table pages, and anything not tagged otherwise
+  LEAF,     // index leaves
+  INDEX,    // index roots and internal pages, header page
+  NUM_PRIORITIES
+};
+
 } // namespace cmudb
\ No newline at end of file
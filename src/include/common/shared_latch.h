@@ -0,0 +1,179 @@
+/**
+ * shared_latch.h
+ *
+ * Shared/exclusive latch in a single 32 bit word. Uncontended acquisitions
+ * and releases are one atomic instruction each. A thread that cannot get
+ * the latch spins for a short while and then parks on the word with a
+ * futex (Linux) or keeps yielding (elsewhere); releases only enter the
+ * kernel when somebody is parked.
+ *
+ * A writer that has to wait for readers blocks new readers, so a steady
+ * stream of readers cannot starve it. A reader can upgrade to exclusive
+ * without releasing the latch, but only one reader at a time: a second
+ * concurrent upgrade fails and has to release and retry.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace cmudb {
+class SharedLatch {
+  static const uint32_t writer_ = 1u << 31;         // held exclusively
+  static const uint32_t writer_waiting_ = 1u << 30; // new readers wait
+  static const uint32_t upgrading_ = 1u << 29;      // a reader is upgrading
+  static const uint32_t parked_ = 1u << 28;         // somebody sleeps on it
+  static const uint32_t readers_ = parked_ - 1;     // reader count mask
+  static const int spins_ = 64; // tries before parking
+
+public:
+  SharedLatch() : word_(0) {}
+
+  SharedLatch(const SharedLatch &) = delete;
+  SharedLatch &operator=(const SharedLatch &) = delete;
+
+  void WLock() {
+    for (int tries = 0;; ++tries) {
+      uint32_t word = word_.load(std::memory_order_relaxed);
+      if ((word & (writer_ | upgrading_ | readers_)) == 0) {
+        // waiting writers set the flag again when they find it taken
+        if (word_.compare_exchange_weak(
+                word, (word & parked_) | writer_, std::memory_order_acquire,
+                std::memory_order_relaxed))
+          return;
+      } else if ((word & writer_waiting_) == 0) {
+        word_.compare_exchange_weak(word, word | writer_waiting_,
+                                    std::memory_order_relaxed);
+      } else {
+        Wait(word, tries);
+      }
+    }
+  }
+
+  bool TryWLock() {
+    uint32_t word = word_.load(std::memory_order_relaxed);
+    while ((word & (writer_ | upgrading_ | readers_)) == 0) {
+      if (word_.compare_exchange_weak(word, (word & parked_) | writer_,
+                                      std::memory_order_acquire,
+                                      std::memory_order_relaxed))
+        return true;
+    }
+    return false;
+  }
+
+  void WUnlock() {
+    uint32_t word =
+        word_.fetch_and(~(writer_ | parked_), std::memory_order_release);
+    if (word & parked_)
+      WakeAll();
+  }
+
+  void RLock() {
+    for (int tries = 0;; ++tries) {
+      uint32_t word = word_.load(std::memory_order_relaxed);
+      if (!Blocked(word)) {
+        if (word_.compare_exchange_weak(word, word + 1,
+                                        std::memory_order_acquire,
+                                        std::memory_order_relaxed))
+          return;
+      } else {
+        Wait(word, tries);
+      }
+    }
+  }
+
+  bool TryRLock() {
+    uint32_t word = word_.load(std::memory_order_relaxed);
+    while (!Blocked(word)) {
+      if (word_.compare_exchange_weak(word, word + 1,
+                                      std::memory_order_acquire,
+                                      std::memory_order_relaxed))
+        return true;
+    }
+    return false;
+  }
+
+  void RUnlock() {
+    uint32_t word = word_.fetch_sub(1, std::memory_order_release);
+    // only the last reader, or the last one besides an upgrading reader,
+    // can let somebody in
+    if ((word & parked_) && (word & readers_) <= 2) {
+      word_.fetch_and(~parked_, std::memory_order_relaxed);
+      WakeAll();
+    }
+  }
+
+  /*
+   * Turn the shared latch the caller holds into an exclusive one, waiting
+   * for the other readers to leave. Returns false, still holding the shared
+   * latch, if another reader is already upgrading
+   */
+  bool Upgrade() {
+    uint32_t word = word_.load(std::memory_order_relaxed);
+    do {
+      if (word & upgrading_)
+        return false;
+    } while (!word_.compare_exchange_weak(word, word | upgrading_,
+                                          std::memory_order_relaxed));
+
+    for (int tries = 0;; ++tries) {
+      word = word_.load(std::memory_order_relaxed);
+      if ((word & readers_) == 1) {
+        if (word_.compare_exchange_weak(
+                word, (word & (parked_ | writer_waiting_)) | writer_,
+                std::memory_order_acquire, std::memory_order_relaxed))
+          return true;
+      } else {
+        Wait(word, tries);
+      }
+    }
+  }
+
+private:
+  static bool Blocked(uint32_t word) {
+    return (word & (writer_ | writer_waiting_ | upgrading_)) != 0 ||
+           (word & readers_) == readers_;
+  }
+
+  /*
+   * Called after the tries-th failed attempt, with the word that made it
+   * fail: spin at first, then sleep until the word changes
+   */
+  void Wait(uint32_t word, int tries) {
+    if (tries < spins_) {
+#if defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#endif
+      return;
+    }
+#ifdef __linux__
+    if ((word & parked_) == 0 &&
+        !word_.compare_exchange_strong(word, word | parked_,
+                                       std::memory_order_relaxed))
+      return;
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word_),
+            FUTEX_WAIT_PRIVATE, word | parked_, nullptr, nullptr, 0);
+#else
+    std::this_thread::yield();
+#endif
+  }
+
+  void WakeAll() {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word_),
+            FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#endif
+  }
+
+  std::atomic<uint32_t> word_;
+};
+} // namespace cmudb
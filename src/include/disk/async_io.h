@@ -0,0 +1,83 @@
+/**
+ * async_io.h
+ *
+ * Functionality: Asynchronous reads and writes of one file, for the disk
+ * manager. Requests are handed over in batches and complete in any order;
+ * each one fulfils its own promise. Two backends:
+ *
+ * IO_URING submits a whole batch to a Linux io_uring with one system call
+ * and reaps completions on a background thread, so a single thread can
+ * keep as many I/Os in flight as the ring has entries. It talks to the
+ * kernel through the raw system calls, no library needed.
+ *
+ * THREAD_POOL hands the requests to a few threads doing pread/pwrite, and
+ * is used wherever io_uring is not available (other platforms, old
+ * kernels, or io_uring disabled by a sandbox).
+ *
+ * Short transfers are finished synchronously, reads are zero-filled past the
+ * end of the file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <string>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <vector>
+
+namespace cmudb {
+
+enum class AsyncIOType { IO_URING = 0, THREAD_POOL };
+
+inline std::string AsyncIOTypeToString(AsyncIOType async_io_type) {
+  switch (async_io_type) {
+  case AsyncIOType::IO_URING:
+    return "IO_URING";
+  case AsyncIOType::THREAD_POOL:
+    return "THREAD_POOL";
+  }
+  return "INVALID";
+}
+
+// pread/pwrite until size bytes are done, the file ends (reads) or there is
+// an error; returns the number of bytes transferred
+size_t ReadFully(int fd, char *data, size_t size, off_t offset);
+size_t WriteFully(int fd, const char *data, size_t size, off_t offset);
+
+// one read or write, owned by the backend from submission to completion
+struct AsyncIORequest {
+  bool write_;
+  char *data_;
+  size_t size_;
+  off_t offset_;
+  // called with the number of bytes transferred, before the promise is
+  // fulfilled
+  std::function<void(size_t)> on_complete_;
+  // true unless the transfer failed
+  std::promise<bool> promise_;
+  struct iovec iov_; // the buffer as io_uring wants it
+};
+
+class AsyncIO {
+public:
+  // backend of the given type for fd, or the thread pool if io_uring cannot
+  // be set up. queue_depth bounds the requests in flight
+  static AsyncIO *Create(AsyncIOType async_io_type, int fd,
+                         size_t queue_depth);
+  // waits for the requests in flight
+  virtual ~AsyncIO() {}
+
+  // start every request, blocks only while the queue is full
+  virtual void Submit(std::vector<AsyncIORequest *> &requests) = 0;
+  virtual AsyncIOType GetType() const = 0;
+
+protected:
+  // finish request, which transferred result bytes so far (negative errno
+  // on failure), and free it
+  static void Complete(int fd, AsyncIORequest *request, ssize_t result);
+};
+
+} // namespace cmudb
@@ -5,31 +5,122 @@
  * database. It also performs read and write of pages to and from disk, and
  * provides a logical file layer within the context of a database management
  * system.
+ * The page size and buffer pool size are per database: they are given when
+ * the database is created and read back from its header page when it is
+ * opened again.
+ * Page I/O uses positional reads and writes (pread/pwrite) on the file
+ * descriptor of the db file, so any number of threads can read and write
+ * pages at the same time without a latch. The size of the db file is cached
+ * and raised by every write that extends it.
+ * Page I/O can also be asynchronous (see async_io.h): requests return a
+ * future right away, and a batch of them is submitted at once, so one
+ * thread can keep many I/Os in flight.
+ * With the MMAP read mode the db file is mapped read-only, and reads of
+ * pages inside the file are a memcpy from the mapping. The mapping spans
+ * MMAP_RESERVE_SIZE bytes from the start, far past the end of the file, so
+ * it never has to be moved or grown: pages become readable through it as
+ * writes extend the file. Writes always go through pwrite, in the order
+ * the callers issue them, so the write-ahead log rules are unaffected.
+ * Deallocated pages are handed out again by AllocatePage. Which pages are
+ * free, and how far the file has been allocated, is kept in a free space map
+ * (see free_space_map.h) that survives the disk manager. Pages allocated
+ * with a hint come from extents of EXTENT_SIZE contiguous pages set aside
+ * for the hint's table, so tables do not interleave on disk.
  */
 
 #pragma once
 #include <atomic>
+#include <cstdint>
 #include <fstream>
 #include <future>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "common/config.h"
+#include "disk/async_io.h"
+#include "disk/free_space_map.h"
 
 namespace cmudb {
 
+// how pages are read from the db file
+enum class ReadMode { PREAD = 0, MMAP };
+
+inline std::string ReadModeToString(ReadMode read_mode) {
+  switch (read_mode) {
+  case ReadMode::PREAD:
+    return "PREAD";
+  case ReadMode::MMAP:
+    return "MMAP";
+  }
+  return "INVALID";
+}
+
+// one request of a batch of asynchronous page I/O
+struct PageIORequest {
+  bool write_;
+  page_id_t page_id_; // first page
+  char *data_;        // num_pages_ pages one after another
+  int num_pages_;
+};
+
 class DiskManager {
 public:
-  DiskManager(const std::string &db_file);
+  DiskManager(const std::string &db_file, int page_size = PAGE_SIZE,
+              int pool_size = BUFFER_POOL_SIZE);
   ~DiskManager();
 
   void WritePage(page_id_t page_id, const char *page_data);
+  // write num_pages consecutive pages kept one after another in pages_data
+  void WritePages(page_id_t first_page_id, const char *pages_data,
+                  int num_pages);
   void ReadPage(page_id_t page_id, char *page_data);
+  // set before the first read; MMAP falls back to PREAD if the file cannot
+  // be mapped
+  void SetReadMode(ReadMode read_mode);
+  inline ReadMode GetReadMode() const { return read_mode_; }
+  // zero-copy read in MMAP mode: the page as it is in the file, read-only
+  // and valid until the disk manager is destroyed. It changes with later
+  // writes of the page. nullptr if the page is not in the file or the mode
+  // is PREAD
+  const char *GetPageView(page_id_t page_id);
+
+  // asynchronous page I/O: the future becomes true once the transfer is
+  // done, false if it failed, and the data must stay valid until then.
+  // Reads past the end of the file come back zero-filled
+  std::future<bool> ReadPageAsync(page_id_t page_id, char *page_data);
+  std::future<bool> WritePageAsync(page_id_t page_id, const char *page_data);
+  std::future<bool> WritePagesAsync(page_id_t first_page_id,
+                                    const char *pages_data, int num_pages);
+  // submit a batch with as few system calls as the backend can, one future
+  // per request
+  std::vector<std::future<bool>>
+  SubmitPageIO(const std::vector<PageIORequest> &requests);
+  // backend for asynchronous I/O, only effective before the first request
+  inline void SetAsyncIOType(AsyncIOType type) { async_io_type_ = type; }
+  // backend in use, io_uring may have fallen back to the thread pool
+  AsyncIOType GetAsyncIOType();
 
   void WriteLog(char *log_data, int size);
   bool ReadLog(char *log_data, int size, int offset);
 
-  page_id_t AllocatePage();
+  // hint: the page the new one is linked from, which puts the new page in
+  // the same extent. Deallocated pages are reused before the file grows
+  page_id_t AllocatePage(page_id_t hint = INVALID_PAGE_ID);
   void DeallocatePage(page_id_t page_id);
+  // deallocated pages waiting to be reused
+  inline size_t GetNumFreePages() {
+    return free_space_map_.GetNumFreePages();
+  }
+  // on by default; off, a hint only picks the nearest free page
+  inline void SetExtentAllocation(bool enabled) {
+    free_space_map_.SetExtentAllocation(enabled);
+  }
+  // number of pages the db file currently spans
+  page_id_t GetNumPages();
+
+  inline int GetPageSize() const { return page_size_; }
+  inline int GetPoolSize() const { return pool_size_; }
 
   int GetNumFlushes() const;
   bool GetFlushState() const;
@@ -38,13 +129,27 @@ public:
 
 private:
   int GetFileSize(const std::string &name);
+  void ExtendFileSize(int64_t end);
+  // backend for asynchronous I/O, set up on first use
+  AsyncIO *GetAsyncIO();
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  std::string fsm_name_;
+  // file descriptor of the db file, for page I/O
+  int db_fd_;
+  // size of the db file in byte, kept up to date by the writes
+  std::atomic<int64_t> db_file_size_;
+  ReadMode read_mode_;
+  // read-only mapping of the db file in MMAP mode
+  char *db_map_;
+  AsyncIOType async_io_type_;
+  AsyncIO *async_io_;
+  std::once_flag async_io_once_;
   std::string file_name_;
-  std::atomic<page_id_t> next_page_id_;
+  int page_size_;
+  int pool_size_;
+  FreeSpaceMap free_space_map_;
   int num_flushes_;
   bool flush_log_;
   std::future<void> *flush_log_f_;
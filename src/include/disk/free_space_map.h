@@ -0,0 +1,104 @@
+/**
+ * free_space_map.h
+ *
+ * Functionality: Which pages of a database are free, for the disk manager to
+ * hand them out again. Page ids below the allocation counter have been
+ * allocated, and those freed since are marked by a set bit; pages from the
+ * counter on were never used.
+ *
+ * Pages are grouped into extents of EXTENT_SIZE pages, one bitmap word each.
+ * An allocation with a hint, the page the new one will be linked from, is
+ * served from the hint's extent; once that is full a whole free extent is
+ * reserved for it, preferably the one right after, so the pages of a table
+ * stay together on disk no matter how its growth interleaves with others.
+ * Allocations without a hint never take reserved pages. Reservations only
+ * live in memory: after a restart the reserved pages are just free, and the
+ * hints lead a table back to its last extent.
+ *
+ * The map is kept in a file of its own next to the db file, so that it takes
+ * no page ids and the header page stays with the upper layers. The file is a
+ * run of map pages of the database's page size:
+ *  ----------------------------------------------------------------
+ * | Magic (4) | NextPageId (4) | free bits of pages 0 .. (8 * PageSize - 65)
+ *  ----------------------------------------------------------------
+ * and every further map page holds the bits of the next as many pages after
+ * its first 8 bytes (NextPageId is only kept in the first one). Every change
+ * is written through to the file right away.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+
+namespace cmudb {
+
+// an extent is one word of the bitmap
+static_assert(EXTENT_SIZE == 64, "EXTENT_SIZE must be 64");
+
+class FreeSpaceMap {
+public:
+  FreeSpaceMap();
+  ~FreeSpaceMap();
+
+  // load the map of a database from file_name, creating it if needed. A
+  // missing or unreadable map is rebuilt from num_pages, the pages the db
+  // file already spans, as allocated; reset starts a new database with no
+  // page allocated
+  void Open(const std::string &file_name, int page_size, page_id_t num_pages,
+            bool reset);
+
+  // a free page: with a hint, one in the hint's extent or else in a newly
+  // reserved extent; without, the lowest one. A new page if none is free
+  page_id_t Allocate(page_id_t hint = INVALID_PAGE_ID);
+  // false if page_id is not allocated
+  bool Deallocate(page_id_t page_id);
+  // without extents a hint only picks the nearest free page in its map page
+  void SetExtentAllocation(bool enabled);
+
+  bool IsAllocated(page_id_t page_id);
+  // one past the highest page id ever allocated, reserved extents included
+  page_id_t GetNextPageId();
+  // reserved pages count as free
+  size_t GetNumFreePages();
+
+private:
+  inline size_t PagesPerMapPage() const { return (words_per_page_ - 1) * 64; }
+  inline uint64_t *Bits(size_t map_page) {
+    return &map_[map_page * words_per_page_ + 1];
+  }
+  inline uint64_t Reserved(size_t extent) const {
+    return extent < reserved_.size() ? reserved_[extent] : 0;
+  }
+  void AddMapPages(size_t map_page);
+  bool IsFree(page_id_t page_id);
+  void SetFree(page_id_t page_id, bool free);
+  // free page in hint's extent nearest to it, INVALID_PAGE_ID if none
+  page_id_t FindInExtent(page_id_t hint);
+  // nearest free page to hint in hint's map page, INVALID_PAGE_ID if none
+  page_id_t FindNear(page_id_t hint);
+  page_id_t FindLowest();
+  // first page of an extent reserved as the successor of hint's
+  page_id_t ReserveExtent(page_id_t hint);
+  void WriteMapPage(size_t map_page);
+
+  std::mutex latch_;
+  int fd_;
+  size_t words_per_page_;
+  // the map pages one after another, as they are in the file
+  std::vector<uint64_t> map_;
+  // free pages counted in each map page
+  std::vector<size_t> free_counts_;
+  size_t num_free_;
+  page_id_t next_page_id_;
+  bool extents_enabled_;
+  // free pages set aside by extent, a bitmap word each
+  std::vector<uint64_t> reserved_;
+  size_t num_reserved_;
+};
+
+} // namespace cmudb
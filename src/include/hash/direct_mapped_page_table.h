@@ -0,0 +1,80 @@
+/**
+ * direct_mapped_page_table.h
+ *
+ * Functionality: Page table for the buffer pool that exploits the dense page
+ * ids handed out by the disk manager. Instead of hashing, a page id indexes
+ * a two-level array directly: a directory of pointers to fixed size leaves
+ * of value slots. A lookup is three dependent loads (directory, leaf, slot)
+ * without hashing, probing or locking.
+ *
+ * The table only holds the ids congruent to offset modulo stride, which are
+ * the ones a buffer pool instance maps, so those are stored densely. Memory
+ * grows with the largest page id inserted, not with the number of entries:
+ * leaves are allocated on first use and the directory doubles when it runs
+ * out of room. Neither is freed before the table is destroyed (replaced
+ * directories included), so a reader never touches freed memory.
+ *
+ * Writers are serialized by a mutex. The default constructed value V() marks
+ * an empty slot and cannot be stored.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "common/config.h"
+#include "hash/hash_table.h"
+
+namespace cmudb {
+
+template <typename V>
+class DirectMappedPageTable : public HashTable<page_id_t, V> {
+public:
+  // expected_pages: directory entries to start with, enough for that many
+  // page ids of this table
+  explicit DirectMappedPageTable(size_t stride = 1, size_t offset = 0,
+                                 size_t expected_pages = 0);
+  ~DirectMappedPageTable();
+
+  // lookup and modifier
+  bool Find(const page_id_t &page_id, V &value) override;
+  bool Remove(const page_id_t &page_id) override;
+  void Insert(const page_id_t &page_id, const V &value) override;
+
+  size_t Size();
+  // page ids [0, capacity) are covered by the directory as it is now
+  size_t GetCapacity();
+
+private:
+  static const size_t leaf_bits_ = 10;
+  static const size_t leaf_size_ = 1 << leaf_bits_;
+
+  struct Leaf {
+    std::atomic<V> slots[leaf_size_];
+    Leaf() {
+      for (auto &slot : slots)
+        slot.store(V(), std::memory_order_relaxed);
+    }
+  };
+  struct Directory {
+    size_t size;
+    std::atomic<Leaf *> *leaves;
+  };
+
+  // index of page_id among the ids of this table, false if it has none
+  bool GetIndex(page_id_t page_id, size_t &index) const;
+  // make the directory hold at least size leaves. Caller holds mtx
+  void GrowDirectory(size_t size);
+
+  size_t stride_;
+  size_t offset_;
+  std::atomic<Directory *> directory_;
+  // directories replaced by larger ones, readers may still be using them
+  std::vector<Directory *> old_directories_;
+  size_t size_;
+  std::mutex mtx;
+};
+
+} // namespace cmudb
@@ -12,6 +12,7 @@
 #include <cstdlib>
 #include <string>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -6,8 +6,24 @@
 
 #pragma once
 
+#include <cstddef>
+#include <string>
+
 namespace cmudb {
 
+// page table implementations a BufferPoolManager can be built with
+enum class PageTableType { LINEAR_PROBE = 0, DIRECT_MAPPED };
+
+inline std::string PageTableTypeToString(PageTableType page_table_type) {
+  switch (page_table_type) {
+  case PageTableType::LINEAR_PROBE:
+    return "LINEAR_PROBE";
+  case PageTableType::DIRECT_MAPPED:
+    return "DIRECT_MAPPED";
+  }
+  return "INVALID";
+}
+
 template <typename K, typename V> class HashTable {
 public:
   HashTable() {}
@@ -16,6 +32,9 @@ public:
   virtual bool Find(const K &key, V &value) = 0;
   virtual bool Remove(const K &key) = 0;
   virtual void Insert(const K &key, const V &value) = 0;
+  // make room for max_size entries, for tables that do not grow by
+  // themselves
+  virtual void Reserve(size_t max_size) { (void)max_size; }
 };
 
 } // namespace cmudb
@@ -0,0 +1,79 @@
+/**
+ * linear_probe_hash_table.h
+ *
+ * Functionality: Fixed capacity open addressing hash table, meant for the
+ * buffer pool page table. The number of entries is bounded by the number of
+ * frames, so the slot array is sized up front (at least twice max_size,
+ * rounded up to a power of two) and only grows when Reserve is told about a
+ * larger bound. Collisions are resolved by linear probing and removals shift
+ * the following entries back, so there are no tombstones and a lookup stops
+ * at the first empty slot.
+ *
+ * Writers are serialized by a mutex. Readers take no lock: every writer
+ * bumps a version counter before and after modifying the slots, and a
+ * lookup that saw the version change retries (seqlock). A hit thus costs one
+ * or two cache lines of slots instead of a tree walk. Keys and values are
+ * kept in std::atomic, so they must be trivially copyable. Slot arrays
+ * replaced by Reserve are kept until the table is destroyed, a lookup may
+ * still be probing one.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+#include "hash/hash_table.h"
+
+namespace cmudb {
+
+template <typename K, typename V>
+class LinearProbeHashTable : public HashTable<K, V> {
+public:
+  // max_size: the most entries the table will ever hold at once
+  explicit LinearProbeHashTable(size_t max_size);
+  ~LinearProbeHashTable();
+
+  // lookup and modifier
+  bool Find(const K &key, V &value) override;
+  bool Remove(const K &key) override;
+  void Insert(const K &key, const V &value) override;
+  void Reserve(size_t max_size) override;
+
+  size_t Size();
+  inline size_t GetCapacity() const {
+    return slots_.load(std::memory_order_acquire)->capacity;
+  }
+
+private:
+  struct Slot {
+    std::atomic<bool> occupied{false};
+    std::atomic<K> key;
+    std::atomic<V> value;
+  };
+  struct SlotArray {
+    size_t capacity; // power of two
+    size_t mask;
+    int shift;
+    Slot *slots;
+  };
+
+  static SlotArray *NewSlotArray(size_t max_size);
+  // home slot of key
+  static size_t HashKey(const SlotArray *array, const K &key);
+  // slot holding key, or capacity if there is none. Caller holds mtx
+  static size_t FindSlot(const SlotArray *array, const K &key);
+  void BeginWrite();
+  void EndWrite();
+
+  std::atomic<SlotArray *> slots_;
+  // slot arrays replaced by larger ones
+  std::vector<SlotArray *> old_slots_;
+  size_t size_;
+  std::atomic<size_t> version_; // odd while a writer is modifying slots
+  std::mutex mtx;
+};
+
+} // namespace cmudb
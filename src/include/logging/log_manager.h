@@ -18,12 +18,13 @@ namespace cmudb {
 
 class LogManager {
 public:
-  LogManager(DiskManager *disk_manager)
+  LogManager(DiskManager *disk_manager,
+             size_t log_buffer_size = LOG_BUFFER_SIZE)
       : next_lsn_(0), persistent_lsn_(INVALID_LSN),
-        disk_manager_(disk_manager) {
+        log_buffer_size_(log_buffer_size), disk_manager_(disk_manager) {
     // TODO: you may intialize your own defined memeber variables here
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
-    flush_buffer_ = new char[LOG_BUFFER_SIZE];
+    log_buffer_ = new char[log_buffer_size_];
+    flush_buffer_ = new char[log_buffer_size_];
   }
 
   ~LogManager() {
@@ -43,6 +44,7 @@ public:
   inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
   inline char *GetLogBuffer() { return log_buffer_; }
+  inline size_t GetLogBufferSize() { return log_buffer_size_; }
 
 private:
   // TODO: you may add your own member variables
@@ -53,6 +55,7 @@ private:
   // log records before & include persistent_lsn_ have been written to disk
   std::atomic<lsn_t> persistent_lsn_;
   // log buffer related
+  size_t log_buffer_size_;
   char *log_buffer_;
   char *flush_buffer_;
   // latch to protect shared member variables
@@ -17,11 +17,12 @@ namespace cmudb {
 class LogRecovery {
 public:
   LogRecovery(DiskManager *disk_manager,
-                    BufferPoolManager *buffer_pool_manager)
+                    BufferPoolManager *buffer_pool_manager,
+                    size_t log_buffer_size = LOG_BUFFER_SIZE)
       : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager),
-        offset_(0) {
+        offset_(0), log_buffer_size_(log_buffer_size) {
     // global transaction through recovery phase
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
+    log_buffer_ = new char[log_buffer_size_];
   }
 
   ~LogRecovery() {
@@ -44,6 +45,7 @@ private:
   std::unordered_map<lsn_t, int> lsn_mapping_;
   // log buffer related
   int offset_;
+  size_t log_buffer_size_; // same as the log manager's
   char *log_buffer_;
 };
 
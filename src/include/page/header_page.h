@@ -4,11 +4,19 @@
  * Database use the first page (page_id = 0) as header page to store metadata, in
  * our case, we will contain information about table/index name (length less than
  * 32 bytes) and their corresponding root_id
+ * The header page also records the page size and buffer pool size the
+ * database was created with, the disk manager reads them back before any
+ * page can be fetched
  *
  * Format (size in byte):
- *  -----------------------------------------------------------------
- * | RecordCount (4) | Entry_1 name (32) | Entry_1 root_id (4) | ... |
- *  -----------------------------------------------------------------
+ *  ----------------------------------------------------------------
+ * | Magic (4) | PageSize (4) | PoolSize (4) | RecordCount (4) | ...
+ *  ----------------------------------------------------------------
+ *  --------------------------------------------------------
+ * ... | Entry_1 name (32) | Entry_1 root_id (4) | ... |
+ *  --------------------------------------------------------
+ * A header page from before the parameters were recorded has no magic and
+ * starts right at RecordCount, it is still read and written in that layout
  */
 
 #pragma once
@@ -21,7 +29,14 @@ namespace cmudb {
 
 class HeaderPage : public Page {
 public:
-  void Init() { SetRecordCount(0); }
+  // bytes at the start of the header page that describe the database
+  static const int DB_PARAMETERS_SIZE = 12;
+
+  void Init(int pool_size = BUFFER_POOL_SIZE);
+  // read the parameters Init recorded from the first DB_PARAMETERS_SIZE bytes
+  // of the header page. Return false if they were never recorded
+  static bool GetDatabaseParameters(const char *data, int &page_size,
+                                    int &pool_size);
   /**
    * Record related
    */
@@ -38,6 +53,9 @@ private:
    * helper functions
    */
   int FindRecord(const std::string &name);
+  bool HasDatabaseParameters();
+  int RecordCountOffset();
+  int RecordsOffset();
 
   void SetRecordCount(int record_count);
 };
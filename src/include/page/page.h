@@ -4,48 +4,133 @@
  * Wrapper around actual data page in main memory and also contains bookkeeping
  * information used by buffer pool manager like pin_count/dirty_flag/page_id.
  * Use page as a basic unit within the database system
+ * The page size is chosen per database, the data area is owned by the buffer
+ * pool manager
+ * The bookkeeping fields are atomic: a buffer pool hit pins the frame
+ * without taking any latch
+ * Besides the shared/exclusive latch, a page can be read optimistically:
+ * take a version snapshot, read without latching (or pinning) anything, then
+ * validate that the version did not change. Write latches bump the version,
+ * and so does the buffer pool whenever the frame changes pages
  */
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
 #include "common/config.h"
-#include "common/rwmutex.h"
+#include "common/shared_latch.h"
 
 namespace cmudb {
 
 class Page {
   friend class BufferPoolManager;
+  friend class FrameArena;
+  template <typename T> friend class PriorityReplacer;
 
 public:
-  Page() { ResetMemory(); }
+  Page() {}
   ~Page(){};
   // get actual data page content
   inline char *GetData() { return data_; }
+  // get size of the data area in byte
+  inline size_t GetPageSize() { return page_size_; }
   // get page id
   inline page_id_t GetPageId() { return page_id_; }
+  // get the index of the frame in its buffer pool instance
+  inline size_t GetFrameId() { return frame_id_; }
   // get page pin count
   inline int GetPinCount() { return pin_count_; }
+  // get the retention priority the buffer pool evicts the page with
+  inline PagePriority GetPriority() { return priority_; }
   // method use to latch/unlatch page content
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
-  inline void WLatch() { rwlatch_.WLock(); }
+  inline void WUnlatch() {
+    EndVersionChange();
+    rwlatch_.WUnlock();
+  }
+  inline void WLatch() {
+    rwlatch_.WLock();
+    BeginVersionChange();
+  }
   inline void RUnlatch() { rwlatch_.RUnlock(); }
   inline void RLatch() { rwlatch_.RLock(); }
+  inline bool TryWLatch() {
+    if (!rwlatch_.TryWLock())
+      return false;
+    BeginVersionChange();
+    return true;
+  }
+  inline bool TryRLatch() { return rwlatch_.TryRLock(); }
+  // read latch to write latch, false if another reader is upgrading
+  inline bool UpgradeLatch() {
+    if (!rwlatch_.Upgrade())
+      return false;
+    BeginVersionChange();
+    return true;
+  }
+  // version snapshot for an optimistic read, false (retry later) while a
+  // writer holds the page
+  inline bool ROptimisticLatch(uint64_t &version) const {
+    version = version_.load(std::memory_order_acquire);
+    return (version & 1) == 0;
+  }
+  // true if nothing changed the page since the snapshot was taken, i.e. the
+  // reads made in between are consistent
+  inline bool RValidate(uint64_t version) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
 
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + 4); }
   inline void SetLSN(lsn_t lsn) { memcpy(GetData() + 4, &lsn, 4); }
 
 private:
   // method used by buffer pool manager
-  inline void ResetMemory() { memset(data_, 0, PAGE_SIZE); }
+  inline void ResetMemory() { memset(data_, 0, page_size_); }
+  // the version is odd from the beginning of a change to its end
+  inline void BeginVersionChange() {
+    version_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+  inline void EndVersionChange() {
+    version_.fetch_add(1, std::memory_order_release);
+  }
   // members
-  char data_[PAGE_SIZE]; // actual data
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  int pin_count_ = 0;
-  bool is_dirty_ = false;
-  RWMutex rwlatch_;
+  char *data_ = nullptr; // actual data
+  size_t page_size_ = 0;
+  size_t frame_id_ = 0;
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  // -1 while the frame is being evicted or deleted, which makes pinning it
+  // without the instance latch fail
+  std::atomic<int> pin_count_{0};
+  std::atomic<bool> is_dirty_{false};
+  // set while the buffer pool reads/writes this frame without holding its
+  // latch; the frame's contents must not be used until it is cleared
+  std::atomic<bool> io_in_progress_{false};
+  // set while the page cleaner writes this frame out; the contents stay
+  // valid, but the frame must not be evicted or deleted meanwhile
+  bool is_flushing_ = false;
+  // taken out of service by a shrinking buffer pool, the frame holds no page
+  // and its pin count stays -1 until the pool grows again
+  bool retired_ = false;
+  // the frame belongs to the ring of bulk reads of its instance and is not
+  // tracked by the replacer
+  std::atomic<bool> in_ring_{false};
+  // the frame is in its instance's replacer, pinned or not
+  std::atomic<bool> in_replacer_{false};
+  // hit since the replacer last looked at it, the replacer is told about
+  // the access before the frame can be evicted
+  std::atomic<bool> referenced_{false};
+  // reset whenever the frame gets a new page, the replacer picks a change
+  // up when it next looks at the frame
+  std::atomic<PagePriority> priority_{PagePriority::HEAP};
+  // the level of its instance's PriorityReplacer the frame is in,
+  // NUM_PRIORITIES if none; guarded by the instance latch
+  PagePriority replacer_priority_ = PagePriority::NUM_PRIORITIES;
+  SharedLatch rwlatch_;
+  std::atomic<uint64_t> version_{0};
 };
 
 } // namespace cmudb
@@ -42,7 +42,8 @@ public:
                    Transaction *txn); // when commit delete or rollback insert
   void RollbackDelete(const RID &rid, Transaction *txn); // when rollback delete
 
-  bool GetTuple(const RID &rid, Tuple &tuple, Transaction *txn);
+  bool GetTuple(const RID &rid, Tuple &tuple, Transaction *txn,
+                AccessStrategy strategy = AccessStrategy::NORMAL);
 
   bool DeleteTableHeap();
 
@@ -2,12 +2,18 @@
  * table_iterator.h
  *
  * For seq scan of table heap
+ * The iterator reads ahead: as it walks the page chain it asks the buffer
+ * pool to prefetch the pages that are likely to come next
+ * Once a scan has gone through more pages than a quarter of the buffer pool
+ * it fetches the rest as BULK_READ, so a large scan does not displace the
+ * working set while small tables that are scanned often stay cached
  */
 
 #pragma once
 
 #include <cassert>
 
+#include "buffer/buffer_pool_manager.h"
 #include "common/rid.h"
 #include "table/tuple.h"
 
@@ -40,9 +46,16 @@ public:
   TableIterator operator++(int);
 
 private:
+  void ReadAhead(page_id_t page_id);
+  AccessStrategy GetStrategy() const;
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  // page ids [read_ahead_begin_, read_ahead_end_) have been prefetched
+  page_id_t read_ahead_begin_;
+  page_id_t read_ahead_end_;
+  size_t pages_scanned_;
 };
 
 } // namespace cmudb
\ No newline at end of file
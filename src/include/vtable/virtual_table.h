@@ -16,6 +16,12 @@
 
 namespace cmudb {
 /* Helpers */
+void OpenStorageEngine(int page_size, int pool_size);
+
+bool ParseModuleArguments(int argc, const char *const *argv,
+                          std::string &index_string, int &page_size,
+                          int &pool_size);
+
 Schema *ParseCreateStatement(const std::string &sql);
 
 IndexMetadata *ParseIndexStatement(std::string &sql,
@@ -60,19 +66,31 @@ int VtabCommit(sqlite3_vtab *pVTab);
 int VtabBegin(sqlite3_vtab *pVTab);
 
 // storage engine
+// page_size and pool_size only apply to a new database, an existing one
+// keeps the ones recorded in its header page
 class StorageEngine {
 public:
-  StorageEngine(std::string db_file_name) {
+  StorageEngine(std::string db_file_name, int page_size = PAGE_SIZE,
+                int pool_size = BUFFER_POOL_SIZE) {
     ENABLE_LOGGING = false;
 
     // storage related
-    disk_manager_ = new DiskManager(db_file_name);
-
-    // log related
-    log_manager_ = new LogManager(disk_manager_);
-
-    buffer_pool_manager_ =
-        new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    disk_manager_ = new DiskManager(db_file_name, page_size, pool_size);
+    page_size = disk_manager_->GetPageSize();
+    pool_size = disk_manager_->GetPoolSize();
+
+    // log related, the log buffer holds as much as the whole buffer pool
+    log_manager_ =
+        new LogManager(disk_manager_, (size_t)(pool_size + 1) * page_size);
+
+    // the B+ tree tags its pages, keep them over heap pages
+    buffer_pool_manager_ = new BufferPoolManager(
+        pool_size, disk_manager_, log_manager_, 1, ReplacerType::LRU,
+        PageTableType::LINEAR_PROBE, HugePageMode::NONE, true);
+    // pages resident at the last clean shutdown are read back in the
+    // background
+    buffer_pool_manager_->EnableWarmUp(
+        db_file_name.substr(0, db_file_name.find(".")) + ".warm");
 
     // txn related
     lock_manager_ = new LockManager(true); // S2PL
@@ -82,8 +100,9 @@ public:
   ~StorageEngine() {
     if (ENABLE_LOGGING)
       log_manager_->StopFlushThread();
-    delete disk_manager_;
+    buffer_pool_manager_->FlushAllPages();
     delete buffer_pool_manager_;
+    delete disk_manager_;
     delete log_manager_;
     delete lock_manager_;
     delete transaction_manager_;
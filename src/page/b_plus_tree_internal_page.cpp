@@ -14,17 +14,17 @@ namespace cmudb {
 /*
  * Init method after creating a new internal page
  * Including set page type, set current size, set page id, set parent id and set
- * max page size
+ * max page size (from the size of the page holding it)
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id,
-                                          page_id_t parent_id) {
+                                          page_id_t parent_id, int page_size) {
   this->SetPageType(IndexPageType::INTERNAL_PAGE);
   this->SetSize(1);
   this->SetPageId(page_id);
   this->SetParentPageId(parent_id);
 
-  int max_size_ = (PAGE_SIZE - sizeof(BPlusTreeInternalPage))/sizeof(MappingType);
+  int max_size_ = (page_size - sizeof(BPlusTreeInternalPage))/sizeof(MappingType);
   this->SetMaxSize(max_size_);
 
 }
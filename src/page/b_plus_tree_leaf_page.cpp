@@ -17,17 +17,18 @@ namespace cmudb {
 /**
  * Init method after creating a new leaf page
  * Including set page type, set current size to zero, set page id/parent id, set
- * next page id and set max size
+ * next page id and set max size (from the size of the page holding it)
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id) {
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id,
+                                      int page_size) {
 
   SetPageId(page_id);
   SetParentPageId(parent_id);
   SetPageType(IndexPageType::LEAF_PAGE);
   SetSize(0);
   SetNextPageId(INVALID_PAGE_ID);
-  int size = (PAGE_SIZE - sizeof(BPlusTreeLeafPage))/ sizeof(MappingType);
+  int size = (page_size - sizeof(BPlusTreeLeafPage))/ sizeof(MappingType);
   SetMaxSize(size);
 
 
@@ -8,6 +8,31 @@
 
 namespace cmudb {
 
+static const int HEADER_MAGIC = 0x43444231; // "CDB1"
+static const int RECORD_SIZE = 36;
+
+/**
+ * Database parameters related
+ */
+void HeaderPage::Init(int pool_size) {
+  int page_size = static_cast<int>(GetPageSize());
+  memcpy(GetData(), &HEADER_MAGIC, 4);
+  memcpy(GetData() + 4, &page_size, 4);
+  memcpy(GetData() + 8, &pool_size, 4);
+  SetRecordCount(0);
+}
+
+bool HeaderPage::GetDatabaseParameters(const char *data, int &page_size,
+                                       int &pool_size) {
+  int magic;
+  memcpy(&magic, data, 4);
+  if (magic != HEADER_MAGIC)
+    return false;
+  memcpy(&page_size, data + 4, 4);
+  memcpy(&pool_size, data + 8, 4);
+  return true;
+}
+
 /**
  * Record related
  */
@@ -17,9 +42,10 @@ bool HeaderPage::InsertRecord(const std::string &name,
   assert(root_id > INVALID_PAGE_ID);
 
   int record_num = GetRecordCount();
-  int offset = 4 + record_num * 36;
-  // check for duplicate name
-  if (FindRecord(name) != -1)
+  int offset = RecordsOffset() + record_num * RECORD_SIZE;
+  // check for duplicate name and for room left in the page
+  if (FindRecord(name) != -1 ||
+      offset + RECORD_SIZE > static_cast<int>(GetPageSize()))
     return false;
   // copy record content
   memcpy(GetData() + offset, name.c_str(), (name.length() + 1));
@@ -37,9 +63,9 @@ bool HeaderPage::DeleteRecord(const std::string &name) {
   // record does not exsit
   if (index == -1)
     return false;
-  int offset = index * 36 + 4;
-  memmove(GetData() + offset, GetData() + offset + 36,
-          (record_num - index - 1) * 36);
+  int offset = RecordsOffset() + index * RECORD_SIZE;
+  memmove(GetData() + offset, GetData() + offset + RECORD_SIZE,
+          (record_num - index - 1) * RECORD_SIZE);
 
   SetRecordCount(record_num - 1);
   return true;
@@ -53,7 +79,7 @@ bool HeaderPage::UpdateRecord(const std::string &name,
   // record does not exsit
   if (index == -1)
     return false;
-  int offset = index * 36 + 4;
+  int offset = RecordsOffset() + index * RECORD_SIZE;
   // update record content, only root_id
   memcpy((GetData() + offset + 32), &root_id, 4);
 
@@ -67,7 +93,7 @@ bool HeaderPage::GetRootId(const std::string &name, page_id_t &root_id) {
   // record does not exsit
   if (index == -1)
     return false;
-  int offset = (index + 1) * 36;
+  int offset = RecordsOffset() + index * RECORD_SIZE + 32;
   root_id = *reinterpret_cast<page_id_t *>(GetData() + offset);
 
   return true;
@@ -76,18 +102,36 @@ bool HeaderPage::GetRootId(const std::string &name, page_id_t &root_id) {
 /**
  * helper functions
  */
+// a header page written before the database parameters has no magic, its
+// record count is at the start of the page and the records follow it
+bool HeaderPage::HasDatabaseParameters() {
+  int magic;
+  memcpy(&magic, GetData(), 4);
+  return magic == HEADER_MAGIC;
+}
+
+int HeaderPage::RecordCountOffset() {
+  return HasDatabaseParameters() ? DB_PARAMETERS_SIZE : 0;
+}
+
+int HeaderPage::RecordsOffset() { return RecordCountOffset() + 4; }
+
 // record count
-int HeaderPage::GetRecordCount() { return *reinterpret_cast<int *>(GetData()); }
+int HeaderPage::GetRecordCount() {
+  return *reinterpret_cast<int *>(GetData() + RecordCountOffset());
+}
 
 void HeaderPage::SetRecordCount(int record_count) {
-  memcpy(GetData(), &record_count, 4);
+  memcpy(GetData() + RecordCountOffset(), &record_count, 4);
 }
 
 int HeaderPage::FindRecord(const std::string &name) {
   int record_num = GetRecordCount();
 
+  int records_offset = RecordsOffset();
   for (int i = 0; i < record_num; i++) {
-    char *raw_name = reinterpret_cast<char *>(GetData() + (4 + i * 36));
+    char *raw_name = reinterpret_cast<char *>(GetData() + records_offset +
+                                              i * RECORD_SIZE);
     if (strcmp(raw_name, name.c_str()) == 0)
       return i;
   }
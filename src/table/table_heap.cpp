@@ -28,13 +28,15 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager,
   first_page->WLatch();
   LOG_DEBUG("new table page created %d", first_page_id_);
 
-  first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
+  first_page->Init(first_page_id_, first_page->GetPageSize(), INVALID_LSN,
+                   log_manager_, txn);
   first_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
 }
 
 bool TableHeap::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn) {
-  if (tuple.size_ + 32 > PAGE_SIZE) { // larger than one page size
+  int page_size = buffer_pool_manager_->GetPageSize();
+  if (tuple.size_ + 32 > page_size) { // larger than one page size
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
@@ -57,9 +59,9 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn) {
       cur_page = static_cast<TablePage *>(
           buffer_pool_manager_->FetchPage(next_page_id));
       cur_page->WLatch();
-    } else { // create new page
-      auto new_page =
-          static_cast<TablePage *>(buffer_pool_manager_->NewPage(next_page_id));
+    } else { // create new page, in the extent of the last one
+      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(
+          next_page_id, PagePriority::HEAP, cur_page->GetPageId()));
       if (new_page == nullptr) {
         cur_page->WUnlatch();
         buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), false);
@@ -70,8 +72,8 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn) {
       // std::cout << "new table page " << next_page_id << " created" <<
       // std::endl;
       cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetPageId(),
-                     log_manager_, txn);
+      new_page->Init(next_page_id, new_page->GetPageSize(),
+                     cur_page->GetPageId(), log_manager_, txn);
       cur_page->WUnlatch();
       buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), true);
       cur_page = new_page;
@@ -140,9 +142,10 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
 }
 
 // called by tuple iterator
-bool TableHeap::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn) {
+bool TableHeap::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn,
+                         AccessStrategy strategy) {
   auto page = static_cast<TablePage *>(
-      buffer_pool_manager_->FetchPage(rid.GetPageId()));
+      buffer_pool_manager_->FetchPage(rid.GetPageId(), strategy));
   if (page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
     return false;
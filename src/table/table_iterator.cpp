@@ -9,12 +9,40 @@
 namespace cmudb {
 
 TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn),
+      read_ahead_begin_(0), read_ahead_end_(0), pages_scanned_(1) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
+    ReadAhead(rid.GetPageId());
     table_heap_->GetTuple(tuple_->rid_, *tuple_, txn_);
   }
 };
 
+/*
+ * Heap pages are chained in the order they were allocated, so the pages
+ * after the one the scan moves to usually have the following page ids. Keep
+ * READ_AHEAD_PAGES of them requested, topping the window up once half of it
+ * has been consumed, and start over if the chain jumps elsewhere
+ */
+void TableIterator::ReadAhead(page_id_t page_id) {
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  if (page_id < read_ahead_begin_ - 1 || page_id >= read_ahead_end_) {
+    read_ahead_begin_ = page_id + 1;
+    read_ahead_end_ = read_ahead_begin_ + READ_AHEAD_PAGES;
+    buffer_pool_manager->PrefetchPages(read_ahead_begin_, READ_AHEAD_PAGES,
+                                       GetStrategy());
+  } else if (read_ahead_end_ - page_id <= READ_AHEAD_PAGES / 2) {
+    buffer_pool_manager->PrefetchPages(read_ahead_end_, READ_AHEAD_PAGES / 2,
+                                       GetStrategy());
+    read_ahead_end_ += READ_AHEAD_PAGES / 2;
+  }
+}
+
+AccessStrategy TableIterator::GetStrategy() const {
+  if (pages_scanned_ > table_heap_->buffer_pool_manager_->GetPoolSize() / 4)
+    return AccessStrategy::BULK_READ;
+  return AccessStrategy::NORMAL;
+}
+
 const Tuple &TableIterator::operator*() {
   assert(*this != table_heap_->end());
   return *tuple_;
@@ -28,7 +56,7 @@ Tuple *TableIterator::operator->() {
 TableIterator &TableIterator::operator++() {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
   auto cur_page = static_cast<TablePage *>(
-      buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
+      buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId(), GetStrategy()));
   cur_page->RLatch();
   assert(cur_page != nullptr); // all pages are pinned
 
@@ -36,8 +64,10 @@ TableIterator &TableIterator::operator++() {
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  next_tuple_rid)) { // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(
-          buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
+      pages_scanned_++;
+      ReadAhead(cur_page->GetNextPageId());
+      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(
+          cur_page->GetNextPageId(), GetStrategy()));
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetPageId(), false);
       cur_page = next_page;
@@ -49,7 +79,7 @@ TableIterator &TableIterator::operator++() {
   tuple_->rid_ = next_tuple_rid;
 
   if (*this != table_heap_->end()) {
-    table_heap_->GetTuple(tuple_->rid_, *tuple_, txn_);
+    table_heap_->GetTuple(tuple_->rid_, *tuple_, txn_, GetStrategy());
   }
   // release until copy the tuple
   cur_page->RUnlatch();
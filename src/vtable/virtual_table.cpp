@@ -20,27 +20,33 @@ SQLITE_EXTENSION_INIT1
 /* API implementation */
 int VtabCreate(sqlite3 *db, void *pAux, int argc, const char *const *argv,
                sqlite3_vtab **ppVtab, char **pzErr) {
+  // the first three parameter:(1) module name (2) database name (3)table name
+  assert(argc >= 4);
+  std::string index_string;
+  int page_size = PAGE_SIZE, pool_size = BUFFER_POOL_SIZE;
+  if (!ParseModuleArguments(argc, argv, index_string, page_size, pool_size)) {
+    *pzErr = sqlite3_mprintf("page_size and pool_size take a number");
+    return SQLITE_ERROR;
+  }
+  OpenStorageEngine(page_size, pool_size);
+
   BufferPoolManager *buffer_pool_manager =
       storage_engine_->buffer_pool_manager_;
   LockManager *lock_manager = storage_engine_->lock_manager_;
   LogManager *log_manager = storage_engine_->log_manager_;
 
   // fetch header page from buffer pool
-  HeaderPage *header_page =
-      static_cast<HeaderPage *>(buffer_pool_manager->FetchPage(HEADER_PAGE_ID));
+  HeaderPage *header_page = static_cast<HeaderPage *>(
+      buffer_pool_manager->FetchPage(HEADER_PAGE_ID, PagePriority::INDEX));
 
-  // the first three parameter:(1) module name (2) database name (3)table name
-  assert(argc >= 4);
   // parse arg[3](string that defines table schema)
   std::string schema_string(argv[3]);
   schema_string = schema_string.substr(1, (schema_string.size() - 2));
   Schema *schema = ParseCreateStatement(schema_string);
 
-  // parse arg[4](string that defines table index)
+  // parse the string that defines table index
   Index *index = nullptr;
-  if (argc > 4) {
-    std::string index_string(argv[4]);
-    index_string = index_string.substr(1, (index_string.size() - 2));
+  if (!index_string.empty()) {
     // create index object, allocate memory space
     IndexMetadata *index_metadata =
         ParseIndexStatement(index_string, std::string(argv[2]), schema);
@@ -65,6 +71,12 @@ int VtabCreate(sqlite3 *db, void *pAux, int argc, const char *const *argv,
 int VtabConnect(sqlite3 *db, void *pAux, int argc, const char *const *argv,
                 sqlite3_vtab **ppVtab, char **pzErr) {
   assert(argc >= 4);
+  // an existing database keeps the parameters it was created with
+  std::string index_string;
+  int page_size = PAGE_SIZE, pool_size = BUFFER_POOL_SIZE;
+  ParseModuleArguments(argc, argv, index_string, page_size, pool_size);
+  OpenStorageEngine(page_size, pool_size);
+
   std::string schema_string(argv[3]);
   // remove the very first and last character
   schema_string = schema_string.substr(1, (schema_string.size() - 2));
@@ -77,15 +89,13 @@ int VtabConnect(sqlite3 *db, void *pAux, int argc, const char *const *argv,
   LogManager *log_manager = storage_engine_->log_manager_;
 
   // Retrieve table root page info from header page
-  HeaderPage *header_page =
-      static_cast<HeaderPage *>(buffer_pool_manager->FetchPage(HEADER_PAGE_ID));
+  HeaderPage *header_page = static_cast<HeaderPage *>(
+      buffer_pool_manager->FetchPage(HEADER_PAGE_ID, PagePriority::INDEX));
   page_id_t table_root_id;
   header_page->GetRootId(std::string(argv[2]), table_root_id);
-  // parse arg[4](string that defines table index)
+  // parse the string that defines table index
   Index *index = nullptr;
-  if (argc > 4) {
-    std::string index_string(argv[4]);
-    index_string = index_string.substr(1, (index_string.size() - 2));
+  if (!index_string.empty()) {
     // create index object, allocate memory space
     IndexMetadata *index_metadata =
         ParseIndexStatement(index_string, std::string(argv[2]), schema);
@@ -153,6 +163,7 @@ int VtabDisconnect(sqlite3_vtab *pVtab) {
   delete virtual_table;
   // delete all the global managers
   delete storage_engine_;
+  storage_engine_ = nullptr;
   return SQLITE_OK;
 }
 
@@ -354,28 +365,78 @@ __declspec(dllexport)
     extern "C" int sqlite3_vtable_init(sqlite3 *db, char **pzErrMsg,
                                        const sqlite3_api_routines *pApi) {
   SQLITE_EXTENSION_INIT2(pApi);
+  // the storage engine is opened by the first table, which may choose the
+  // parameters of a new database
+  storage_engine_ = nullptr;
+  int rc = sqlite3_create_module(db, "vtable", &VtableModule, nullptr);
+  return rc;
+}
+
+/* Helpers */
+/*
+ * Open the database file, creating it with page_size and pool_size if it
+ * does not exist yet; an existing one keeps the parameters recorded in its
+ * header page. Does nothing if the storage engine is open already
+ */
+void OpenStorageEngine(int page_size, int pool_size) {
+  if (storage_engine_ != nullptr)
+    return;
   std::string db_file_name = "vtable.db";
   struct stat buffer;
   bool is_file_exist = (stat(db_file_name.c_str(), &buffer) == 0);
 
   // init storage engine
-  storage_engine_ = new StorageEngine(db_file_name);
+  storage_engine_ = new StorageEngine(db_file_name, page_size, pool_size);
   // start the logging
   storage_engine_->log_manager_->RunFlushThread();
   // create header page from BufferPoolManager if necessary
   if (!is_file_exist) {
     page_id_t header_page_id;
-    storage_engine_->buffer_pool_manager_->NewPage(header_page_id);
+    HeaderPage *header_page = static_cast<HeaderPage *>(
+        storage_engine_->buffer_pool_manager_->NewPage(header_page_id,
+                                                       PagePriority::INDEX));
 
     assert(header_page_id == HEADER_PAGE_ID);
+    // record the parameters the database is created with
+    header_page->Init(storage_engine_->disk_manager_->GetPoolSize());
     storage_engine_->buffer_pool_manager_->UnpinPage(header_page_id, true);
   }
+}
 
-  int rc = sqlite3_create_module(db, "vtable", &VtableModule, nullptr);
-  return rc;
+/*
+ * Sort the module arguments after the schema (argv[3]): page_size=N and
+ * pool_size=N choose the parameters of a new database, the first other one
+ * defines the index. Quotes around an argument are dropped. Return false if
+ * an option is not a positive number
+ */
+bool ParseModuleArguments(int argc, const char *const *argv,
+                          std::string &index_string, int &page_size,
+                          int &pool_size) {
+  for (int i = 4; i < argc; i++) {
+    std::string arg(argv[i]);
+    if (arg.size() >= 2 && arg.front() == '\'' && arg.back() == '\'')
+      arg = arg.substr(1, arg.size() - 2);
+    std::string::size_type n = arg.find('=');
+    std::string name = arg.substr(0, n);
+    StringUtility::Trim(name);
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    if (n == std::string::npos ||
+        (name != "page_size" && name != "pool_size")) {
+      if (index_string.empty())
+        index_string = arg;
+      continue;
+    }
+    std::string value = arg.substr(n + 1);
+    StringUtility::Trim(value);
+    if (value.empty() || value.size() > 9 ||
+        value.find_first_not_of("0123456789") != std::string::npos ||
+        std::stoi(value) == 0)
+      return false;
+    (name == "page_size" ? page_size : pool_size) = std::stoi(value);
+  }
+  return true;
 }
 
-/* Helpers */
 Schema *ParseCreateStatement(const std::string &sql_base) {
   std::string::size_type n;
   std::vector<Column> v;
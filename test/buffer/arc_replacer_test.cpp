@@ -0,0 +1,189 @@
+/**
+ * arc_replacer_test.cpp
+ */
+
+#include <cstdio>
+
+#include "buffer/arc_replacer.h"
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer<int> arc_replacer(4);
+
+  // 1, 2, 3 are referenced once (T1), 1 again (T2)
+  arc_replacer.Insert(1);
+  arc_replacer.Insert(2);
+  arc_replacer.Insert(3);
+  EXPECT_EQ(true, arc_replacer.Erase(1));
+  arc_replacer.Insert(1);
+  EXPECT_EQ(3, arc_replacer.Size());
+
+  // T1 is above its target (0), so pages seen once go first
+  int value;
+  EXPECT_EQ(true, arc_replacer.Victim(value));
+  EXPECT_EQ(2, value);
+  EXPECT_EQ(true, arc_replacer.Victim(value));
+  EXPECT_EQ(3, value);
+
+  // pinned pages are skipped
+  EXPECT_EQ(true, arc_replacer.Erase(1));
+  EXPECT_EQ(false, arc_replacer.Erase(1));
+  EXPECT_EQ(false, arc_replacer.Victim(value));
+  EXPECT_EQ(0, arc_replacer.Size());
+
+  // 2 comes back while its page id is still in B1: T1 was too small
+  EXPECT_EQ(0, arc_replacer.GetTarget());
+  arc_replacer.Insert(2);
+  EXPECT_EQ(1, arc_replacer.GetTarget());
+  arc_replacer.Insert(4);
+  arc_replacer.Insert(1);
+
+  // T1 = {4} does not exceed the target, so T2 gives up its LRU page
+  EXPECT_EQ(true, arc_replacer.Victim(value));
+  EXPECT_EQ(2, value);
+  // 2 comes back from B2, shrinking the target again
+  arc_replacer.Insert(2);
+  EXPECT_EQ(0, arc_replacer.GetTarget());
+  EXPECT_EQ(true, arc_replacer.Victim(value));
+  EXPECT_EQ(4, value);
+}
+
+TEST(ARCReplacerTest, GhostBoundTest) {
+  ARCReplacer<int> arc_replacer(4);
+
+  // 1 is referenced twice (T2), then a scan streams through T1
+  arc_replacer.Insert(1);
+  arc_replacer.Erase(1);
+  arc_replacer.Insert(1);
+  int value;
+  for (int i = 10; i < 20; ++i) {
+    if (i >= 13) {
+      EXPECT_EQ(true, arc_replacer.Victim(value));
+      EXPECT_EQ(i - 3, value);
+    }
+    arc_replacer.Insert(i);
+  }
+
+  // T1 + B1 never exceed the capacity, so only the most recently evicted
+  // scan pages are remembered
+  EXPECT_EQ(true, arc_replacer.Victim(value));
+  EXPECT_EQ(17, value);
+  arc_replacer.Insert(12);
+  EXPECT_EQ(0, arc_replacer.GetTarget());
+  EXPECT_EQ(true, arc_replacer.Victim(value));
+  EXPECT_EQ(18, value);
+  arc_replacer.Insert(16);
+  EXPECT_EQ(0, arc_replacer.GetTarget());
+  EXPECT_EQ(true, arc_replacer.Victim(value));
+  EXPECT_EQ(19, value);
+  arc_replacer.Insert(18);
+  EXPECT_EQ(1, arc_replacer.GetTarget());
+
+  // the page referenced twice survived the whole scan
+  EXPECT_EQ(true, arc_replacer.Erase(1));
+}
+
+TEST(ARCReplacerTest, SharedCapacityTest) {
+  // two priority levels of a pool of 4 frames, holding 2 each; the same
+  // churn through a replacer of its own for comparison
+  ARCReplacer<int> heap(4, true), index(4, true), alone(4);
+  int value;
+  for (int i = 0; i < 20; ++i) {
+    for (ARCReplacer<int> *level : {&heap, &index, &alone}) {
+      if (i >= 2) {
+        EXPECT_EQ(true, level->Victim(value));
+      }
+      // referenced twice, so that the evicted pages go to B2
+      level->Insert(i);
+      level->Erase(i);
+      level->Insert(i);
+    }
+  }
+  // a replacer of its own remembers up to 2 * capacity pages in total, the
+  // levels no more ghosts than they hold pages
+  EXPECT_EQ(6, alone.GetNumGhosts());
+  EXPECT_EQ(1, heap.GetNumGhosts());
+  EXPECT_EQ(1, index.GetNumGhosts());
+
+  // the ghosts left still adapt the target
+  heap.Insert(50);
+  EXPECT_EQ(true, heap.Victim(value));
+  EXPECT_EQ(50, value);
+  heap.Insert(50);
+  EXPECT_EQ(1, heap.GetTarget());
+}
+
+TEST(ARCReplacerTest, BufferPoolTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(4, disk_manager, nullptr, 1, ReplacerType::ARC);
+
+  // page 0 is referenced twice, pages 1-3 once
+  for (int i = 0; i < 4; ++i) {
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  ASSERT_NE(nullptr, bpm.FetchPage(0));
+  EXPECT_EQ(true, bpm.UnpinPage(0, false));
+
+  // a scan over new pages cycles through T1 and leaves page 0 alone
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  auto page_zero = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page_zero);
+  EXPECT_EQ(0, strcmp(page_zero->GetData(), "page 0"));
+  EXPECT_EQ(true, bpm.UnpinPage(0, false));
+
+  // evicted pages are still read back correctly
+  auto page_one = bpm.FetchPage(1);
+  ASSERT_NE(nullptr, page_one);
+  EXPECT_EQ(0, strcmp(page_one->GetData(), "page 1"));
+  EXPECT_EQ(true, bpm.UnpinPage(1, false));
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+TEST(ARCReplacerTest, ReusedPageIdTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(3, disk_manager, nullptr, 1, ReplacerType::ARC);
+
+  // pages 0-3, page 0 is evicted
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  // page 1's frame goes to page 0, and page id 1 to another frame
+  EXPECT_EQ(true, bpm.DeletePage(1));
+  Page *page_zero = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page_zero);
+  Page *page_one = bpm.NewPage(temp_page_id);
+  ASSERT_NE(nullptr, page_one);
+  EXPECT_EQ(1, temp_page_id);
+  EXPECT_NE(page_zero, page_one);
+  EXPECT_EQ(true, bpm.UnpinPage(1, true));
+  // the old frame of page 1 comes back with page 0, page 1 must stay
+  EXPECT_EQ(true, bpm.UnpinPage(0, false));
+
+  // every frame can still be evicted
+  ASSERT_NE(nullptr, bpm.FetchPage(2));
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+  }
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.fsm");
+}
+
+} // namespace cmudb
@@ -0,0 +1,126 @@
+/**
+ * clock_replacer_test.cpp
+ */
+
+#include <cstdio>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/clock_replacer.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(ClockReplacerTest, SampleTest) {
+  ClockReplacer<int> clock_replacer;
+
+  // push element into replacer
+  clock_replacer.Insert(1);
+  clock_replacer.Insert(2);
+  clock_replacer.Insert(3);
+  clock_replacer.Insert(4);
+  clock_replacer.Insert(5);
+  clock_replacer.Insert(6);
+  clock_replacer.Insert(1);
+
+  EXPECT_EQ(6, clock_replacer.Size());
+
+  // every value has its reference bit set, so the first sweep clears them
+  // all and the hand comes back around to 1
+  int value;
+  EXPECT_EQ(true, clock_replacer.Victim(value));
+  EXPECT_EQ(1, value);
+  EXPECT_EQ(true, clock_replacer.Victim(value));
+  EXPECT_EQ(2, value);
+
+  // a referenced value survives the next pass of the hand
+  clock_replacer.Insert(3);
+  EXPECT_EQ(true, clock_replacer.Victim(value));
+  EXPECT_EQ(4, value);
+
+  // remove element from replacer
+  EXPECT_EQ(false, clock_replacer.Erase(4));
+  EXPECT_EQ(true, clock_replacer.Erase(6));
+  EXPECT_EQ(2, clock_replacer.Size());
+
+  EXPECT_EQ(true, clock_replacer.Victim(value));
+  EXPECT_EQ(5, value);
+  EXPECT_EQ(true, clock_replacer.Victim(value));
+  EXPECT_EQ(3, value);
+  EXPECT_EQ(false, clock_replacer.Victim(value));
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+TEST(ClockReplacerTest, ConcurrentTest) {
+  const int num_threads = 4;
+  ClockReplacer<int> clock_replacer;
+
+  // Insert and Erase run without the latch, each thread on its own values,
+  // which are spread over several chunks of slots
+  std::vector<std::thread> threads;
+  std::vector<std::set<int>> inserted(num_threads);
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.push_back(std::thread([&clock_replacer, &inserted, tid]() {
+      std::mt19937 rng(tid);
+      for (int i = 0; i < 10000; ++i) {
+        int value = tid * 3000 + rng() % 100;
+        if (rng() % 2 == 0) {
+          clock_replacer.Insert(value);
+          inserted[tid].insert(value);
+        } else {
+          EXPECT_EQ(inserted[tid].erase(value) == 1,
+                    clock_replacer.Erase(value));
+        }
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::set<int> expected;
+  for (auto &values : inserted) {
+    expected.insert(values.begin(), values.end());
+  }
+  EXPECT_EQ(expected.size(), clock_replacer.Size());
+  int value;
+  while (clock_replacer.Victim(value)) {
+    EXPECT_EQ(1, expected.erase(value));
+  }
+  EXPECT_EQ(0, expected.size());
+}
+
+TEST(ClockReplacerTest, BufferPoolTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager, nullptr, 1, ReplacerType::CLOCK);
+
+  auto page_zero = bpm.NewPage(temp_page_id);
+  ASSERT_NE(nullptr, page_zero);
+  strcpy(page_zero->GetData(), "Hello");
+
+  for (int i = 1; i < 10; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  }
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(true, bpm.UnpinPage(i, true));
+  }
+  // evict every page written so far
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  }
+  EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+  page_zero = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page_zero);
+  EXPECT_EQ(0, strcmp(page_zero->GetData(), "Hello"));
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+} // namespace cmudb
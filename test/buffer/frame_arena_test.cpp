@@ -0,0 +1,100 @@
+/**
+ * frame_arena_test.cpp
+ */
+
+#include <cstdint>
+#include <cstring>
+
+#include "buffer/frame_arena.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(FrameArenaTest, LayoutTest) {
+  FrameArena arena(10, 1024);
+  EXPECT_EQ(10, arena.Size());
+  EXPECT_EQ(HugePageMode::NONE, arena.GetHugePageMode());
+
+  for (size_t i = 0; i < arena.Size(); ++i) {
+    Page *page = arena.GetPage(i);
+    EXPECT_EQ(1024, page->GetPageSize());
+    EXPECT_EQ(INVALID_PAGE_ID, page->GetPageId());
+    EXPECT_EQ(0, page->GetPinCount());
+    // data areas are consecutive, aligned to the page size and zeroed
+    EXPECT_EQ(arena.GetPage(0)->GetData() + i * 1024, page->GetData());
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % 1024);
+    EXPECT_EQ(0, page->GetData()[0]);
+    EXPECT_EQ(0, page->GetData()[1023]);
+    // every descriptor has cache lines of its own, after the data
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page) % CACHELINE_SIZE);
+    EXPECT_LE(reinterpret_cast<char *>(arena.GetPage(9)->GetData() + 1024),
+              reinterpret_cast<char *>(page));
+    if (i > 0) {
+      EXPECT_LE(reinterpret_cast<char *>(arena.GetPage(i - 1)) + sizeof(Page),
+                reinterpret_cast<char *>(page));
+    }
+  }
+}
+
+TEST(FrameArenaTest, LargePageTest) {
+  // pages larger than the system's still start at a multiple of their size,
+  // whatever address the mapping happens to get
+  for (size_t page_size : {8192, 16384, 65536}) {
+    for (size_t num_frames : {1, 3, 7}) {
+      FrameArena arena(num_frames, page_size);
+      for (size_t i = 0; i < arena.Size(); ++i) {
+        char *data = arena.GetPage(i)->GetData();
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(data) % page_size);
+        EXPECT_EQ(page_size, arena.GetPage(i)->GetPageSize());
+        memset(data, 'a' + i, page_size);
+      }
+      for (size_t i = 0; i < arena.Size(); ++i) {
+        EXPECT_EQ(static_cast<char>('a' + i),
+                  arena.GetPage(i)->GetData()[page_size - 1]);
+      }
+    }
+  }
+}
+
+TEST(FrameArenaTest, ReleaseTest) {
+  FrameArena arena(16, 512);
+  for (size_t i = 0; i < arena.Size(); ++i) {
+    memset(arena.GetPage(i)->GetData(), 'a' + i, 512);
+  }
+
+  // the descriptors survive releasing the data, which reads back as zeros
+  arena.ReleaseData();
+  EXPECT_TRUE(arena.IsReleased());
+  for (size_t i = 0; i < arena.Size(); ++i) {
+    EXPECT_EQ(512, arena.GetPage(i)->GetPageSize());
+#ifdef __linux__
+    EXPECT_EQ(0, arena.GetPage(i)->GetData()[0]);
+#endif
+  }
+  arena.ReuseData();
+  EXPECT_FALSE(arena.IsReleased());
+  strcpy(arena.GetPage(3)->GetData(), "Hello");
+  EXPECT_EQ(0, strcmp(arena.GetPage(3)->GetData(), "Hello"));
+}
+
+TEST(FrameArenaTest, HugePageTest) {
+  // without reserved huge pages HUGETLB falls back to transparent ones
+  for (HugePageMode mode :
+       {HugePageMode::TRANSPARENT, HugePageMode::HUGETLB}) {
+    FrameArena arena(100, 4096, mode);
+#ifdef __linux__
+    EXPECT_NE(HugePageMode::NONE, arena.GetHugePageMode());
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(arena.GetPage(0)->GetData()) %
+                     HUGE_PAGE_SIZE);
+#endif
+    for (size_t i = 0; i < arena.Size(); ++i) {
+      memset(arena.GetPage(i)->GetData(), static_cast<int>(i), 4096);
+    }
+    for (size_t i = 0; i < arena.Size(); ++i) {
+      EXPECT_EQ(static_cast<char>(i), arena.GetPage(i)->GetData()[4095]);
+    }
+    arena.ReleaseData();
+  }
+}
+
+} // namespace cmudb
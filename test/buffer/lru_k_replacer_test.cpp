@@ -0,0 +1,145 @@
+/**
+ * lru_k_replacer_test.cpp
+ */
+
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer<int> lru_k_replacer(2);
+
+  // 1 and 2 are referenced twice, the others only once
+  lru_k_replacer.Insert(1);
+  lru_k_replacer.Insert(2);
+  lru_k_replacer.Insert(3);
+  lru_k_replacer.Insert(4);
+  lru_k_replacer.Insert(1);
+  lru_k_replacer.Insert(5);
+  lru_k_replacer.Insert(2);
+  EXPECT_EQ(5, lru_k_replacer.Size());
+
+  // values with fewer than K references go first, least recent first
+  int value;
+  EXPECT_EQ(true, lru_k_replacer.Victim(value));
+  EXPECT_EQ(3, value);
+  EXPECT_EQ(true, lru_k_replacer.Victim(value));
+  EXPECT_EQ(4, value);
+
+  // a pinned value keeps its history
+  EXPECT_EQ(true, lru_k_replacer.Erase(1));
+  EXPECT_EQ(false, lru_k_replacer.Erase(1));
+  EXPECT_EQ(2, lru_k_replacer.Size());
+  EXPECT_EQ(true, lru_k_replacer.Victim(value));
+  EXPECT_EQ(5, value);
+  lru_k_replacer.Insert(1);
+
+  // 1 now has references at t=5,8 and 2 at t=2,7: 2's second most recent
+  // reference is older, so it goes first
+  EXPECT_EQ(true, lru_k_replacer.Victim(value));
+  EXPECT_EQ(2, value);
+  EXPECT_EQ(true, lru_k_replacer.Victim(value));
+  EXPECT_EQ(1, value);
+  EXPECT_EQ(false, lru_k_replacer.Victim(value));
+
+  // an evicted value starts over with an empty history
+  lru_k_replacer.Insert(1);
+  lru_k_replacer.Insert(6);
+  lru_k_replacer.Insert(6);
+  EXPECT_EQ(true, lru_k_replacer.Victim(value));
+  EXPECT_EQ(1, value);
+}
+
+TEST(LRUKReplacerTest, CorrelatedPeriodTest) {
+  LRUKReplacer<int> lru_k_replacer(2, 2);
+
+  lru_k_replacer.Insert(1);
+  // within the correlated period: still a single reference
+  lru_k_replacer.Insert(1);
+  lru_k_replacer.Insert(2);
+  lru_k_replacer.Insert(3);
+  lru_k_replacer.Insert(2);
+
+  // 1 is outside its correlated period now, 3 is not
+  std::vector<int> victims;
+  lru_k_replacer.PeekVictims(victims, 3);
+  EXPECT_EQ(std::vector<int>({1, 3, 2}), victims);
+  int value;
+  EXPECT_EQ(true, lru_k_replacer.Victim(value));
+  EXPECT_EQ(1, value);
+  // 2 was referenced twice but its references are correlated
+  EXPECT_EQ(true, lru_k_replacer.Victim(value));
+  EXPECT_EQ(3, value);
+  EXPECT_EQ(true, lru_k_replacer.Victim(value));
+  EXPECT_EQ(2, value);
+}
+
+TEST(LRUKReplacerTest, CorrelatedOrderTest) {
+  const size_t k = 2, period = 8;
+  LRUKReplacer<int> lru_k_replacer(k, period);
+  // every reference of every value, evicted ones forgotten
+  std::map<int, std::vector<size_t>> history;
+  std::map<int, bool> evictable;
+  size_t now = 0;
+  std::mt19937 rng(0);
+  for (int i = 0; i < 2000; ++i) {
+    int value = rng() % 32;
+    switch (rng() % 4) {
+    case 0: {
+      // the victim as a linear scan would pick it
+      int expected = -1;
+      std::pair<bool, size_t> best, best_settled;
+      bool settled = false;
+      for (auto &entry : history) {
+        if (!evictable[entry.first])
+          continue;
+        std::vector<size_t> &refs = entry.second;
+        std::pair<bool, size_t> key(refs.size() >= k,
+                                    refs.size() >= k ? refs[k - 1] : refs[0]);
+        if (now - refs[0] > period && (!settled || key < best_settled)) {
+          settled = true;
+          best_settled = key;
+          expected = entry.first;
+        } else if (!settled && (expected < 0 || key < best)) {
+          best = key;
+          expected = entry.first;
+        }
+      }
+      int victim;
+      EXPECT_EQ(expected >= 0, lru_k_replacer.Victim(victim));
+      if (expected >= 0) {
+        EXPECT_EQ(expected, victim);
+        history.erase(victim);
+        evictable.erase(victim);
+      }
+      break;
+    }
+    case 1:
+      EXPECT_EQ(evictable[value], lru_k_replacer.Erase(value));
+      evictable[value] = false;
+      break;
+    default: {
+      lru_k_replacer.Insert(value);
+      std::vector<size_t> &refs = history[value];
+      ++now;
+      if (!refs.empty() && now - refs[0] <= period) {
+        refs[0] = now;
+      } else {
+        refs.insert(refs.begin(), now);
+        if (refs.size() > k)
+          refs.pop_back();
+      }
+      evictable[value] = true;
+      break;
+    }
+    }
+  }
+}
+
+} // namespace cmudb
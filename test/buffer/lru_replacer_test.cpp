@@ -45,4 +45,21 @@ TEST(LRUReplacerTest, SampleTest) {
   EXPECT_EQ(1, value);
 }
 
+TEST(LRUReplacerTest, PeekVictimsTest) {
+  LRUReplacer<int> lru_replacer;
+  for (int i = 1; i <= 4; ++i)
+    lru_replacer.Insert(i);
+  lru_replacer.Insert(1);
+
+  // peeking leaves the replacer untouched
+  std::vector<int> values;
+  lru_replacer.PeekVictims(values, 3);
+  EXPECT_EQ(std::vector<int>({2, 3, 4}), values);
+  EXPECT_EQ(4, lru_replacer.Size());
+
+  int value;
+  lru_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+}
+
 } // namespace cmudb
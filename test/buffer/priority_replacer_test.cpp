@@ -0,0 +1,56 @@
+/**
+ * priority_replacer_test.cpp
+ */
+
+#include <vector>
+
+#include "buffer/lru_replacer.h"
+#include "buffer/priority_replacer.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+static PriorityReplacer<int> *NewLRUPriorityReplacer() {
+  std::vector<Replacer<int> *> levels;
+  for (int i = 0; i < static_cast<int>(PagePriority::NUM_PRIORITIES); ++i)
+    levels.push_back(new LRUReplacer<int>);
+  return new PriorityReplacer<int>(levels);
+}
+
+TEST(PriorityReplacerTest, SampleTest) {
+  PriorityReplacer<int> *replacer = NewLRUPriorityReplacer();
+
+  replacer->Insert(1, PagePriority::INDEX);
+  replacer->Insert(2, PagePriority::LEAF);
+  replacer->Insert(3); // HEAP
+  replacer->Insert(4, PagePriority::SCAN);
+  replacer->Insert(5, PagePriority::HEAP);
+  replacer->Insert(6, PagePriority::INDEX);
+  EXPECT_EQ(6, replacer->Size());
+  EXPECT_EQ(2, replacer->Size(PagePriority::HEAP));
+  EXPECT_EQ(2, replacer->Size(PagePriority::INDEX));
+
+  // lowest priority first, least recently used first within one
+  std::vector<int> peeked;
+  replacer->PeekVictims(peeked, 4);
+  EXPECT_EQ((std::vector<int>{4, 3, 5, 2}), peeked);
+
+  // a plain insert keeps the priority, a tagged one moves the value
+  replacer->Insert(3);
+  replacer->Insert(5, PagePriority::INDEX);
+  EXPECT_EQ(1, replacer->Size(PagePriority::HEAP));
+  EXPECT_EQ(3, replacer->Size(PagePriority::INDEX));
+
+  int value;
+  std::vector<int> victims;
+  EXPECT_EQ(true, replacer->Erase(2));
+  EXPECT_EQ(false, replacer->Erase(2));
+  while (replacer->Victim(value))
+    victims.push_back(value);
+  EXPECT_EQ((std::vector<int>{4, 3, 1, 6, 5}), victims);
+  EXPECT_EQ(0, replacer->Size());
+
+  delete replacer;
+}
+
+} // namespace cmudb
@@ -0,0 +1,118 @@
+/**
+ * shared_latch_test.cpp
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "common/shared_latch.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(SharedLatchTest, BasicTest) {
+  const int num_threads = 8;
+  const int num_rounds = 20000;
+  SharedLatch latch;
+  // written only under the exclusive latch, the two halves must match
+  // whenever a reader looks
+  int first = 0, second = 0;
+  std::vector<int> torn_reads(num_threads, 0);
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.push_back(std::thread([&, tid]() {
+      for (int i = 0; i < num_rounds; ++i) {
+        if ((i + tid) % 4 == 0) {
+          latch.WLock();
+          first++;
+          second++;
+          latch.WUnlock();
+        } else {
+          latch.RLock();
+          if (first != second)
+            torn_reads[tid]++;
+          latch.RUnlock();
+        }
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (int tid = 0; tid < num_threads; ++tid) {
+    EXPECT_EQ(0, torn_reads[tid]);
+  }
+  EXPECT_EQ(num_threads * num_rounds / 4, first);
+  EXPECT_EQ(first, second);
+}
+
+TEST(SharedLatchTest, TryLockTest) {
+  SharedLatch latch;
+
+  EXPECT_TRUE(latch.TryRLock());
+  EXPECT_TRUE(latch.TryRLock());
+  EXPECT_FALSE(latch.TryWLock());
+  latch.RUnlock();
+  latch.RUnlock();
+
+  EXPECT_TRUE(latch.TryWLock());
+  EXPECT_FALSE(latch.TryWLock());
+  EXPECT_FALSE(latch.TryRLock());
+  latch.WUnlock();
+
+  // a writer waiting for readers keeps new readers out
+  latch.RLock();
+  std::atomic<bool> locked(false);
+  std::thread writer([&latch, &locked]() {
+    latch.WLock();
+    locked = true;
+    latch.WUnlock();
+  });
+  while (latch.TryRLock()) {
+    latch.RUnlock();
+    std::this_thread::yield();
+  }
+  EXPECT_FALSE(locked);
+  latch.RUnlock();
+  writer.join();
+  EXPECT_TRUE(locked);
+  EXPECT_TRUE(latch.TryRLock());
+  latch.RUnlock();
+}
+
+TEST(SharedLatchTest, UpgradeTest) {
+  SharedLatch latch;
+  int value = 0;
+
+  latch.RLock();
+  std::atomic<bool> upgraded(false);
+  std::thread upgrader([&latch, &upgraded, &value]() {
+    latch.RLock();
+    EXPECT_TRUE(latch.Upgrade());
+    upgraded = true;
+    value = 1;
+    latch.WUnlock();
+  });
+  // the upgrade waits for the other reader, and a second one fails
+  while (latch.TryRLock()) {
+    latch.RUnlock();
+    std::this_thread::yield();
+  }
+  EXPECT_FALSE(latch.Upgrade());
+  EXPECT_FALSE(upgraded);
+  EXPECT_EQ(0, value);
+  latch.RUnlock();
+  upgrader.join();
+
+  latch.RLock();
+  EXPECT_EQ(1, value);
+  EXPECT_TRUE(latch.Upgrade());
+  EXPECT_FALSE(latch.TryRLock());
+  latch.WUnlock();
+  EXPECT_TRUE(latch.TryWLock());
+  latch.WUnlock();
+}
+
+} // namespace cmudb
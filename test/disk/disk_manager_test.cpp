@@ -0,0 +1,194 @@
+/**
+ * disk_manager_test.cpp
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "disk/disk_manager.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(DiskManagerTest, SampleTest) {
+  remove("test.db");
+  char data[PAGE_SIZE];
+  char buffer[PAGE_SIZE];
+  {
+    DiskManager disk_manager("test.db");
+    EXPECT_EQ(0, disk_manager.GetNumPages());
+
+    // past the end of the file the read is refused, buffer stays as it is
+    strcpy(buffer, "untouched");
+    disk_manager.ReadPage(3, buffer);
+    EXPECT_EQ(0, strcmp(buffer, "untouched"));
+
+    strcpy(data, "page 2");
+    disk_manager.WritePage(2, data);
+    EXPECT_EQ(3, disk_manager.GetNumPages());
+    disk_manager.ReadPage(2, buffer);
+    EXPECT_EQ(0, strcmp(buffer, "page 2"));
+    // never written, but inside the file
+    disk_manager.ReadPage(0, buffer);
+    EXPECT_EQ(0, buffer[0]);
+
+    char pages[3 * PAGE_SIZE] = {};
+    for (int i = 0; i < 3; ++i) {
+      snprintf(pages + i * PAGE_SIZE, PAGE_SIZE, "page %d", 4 + i);
+    }
+    disk_manager.WritePages(4, pages, 3);
+    EXPECT_EQ(7, disk_manager.GetNumPages());
+    disk_manager.ReadPage(5, buffer);
+    EXPECT_EQ(0, strcmp(buffer, "page 5"));
+  }
+
+  // the file size is picked up again when the file is reopened
+  DiskManager disk_manager("test.db");
+  EXPECT_EQ(7, disk_manager.GetNumPages());
+  disk_manager.ReadPage(6, buffer);
+  EXPECT_EQ(0, strcmp(buffer, "page 6"));
+
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(DiskManagerTest, ConcurrentTest) {
+  remove("test.db");
+  DiskManager disk_manager("test.db");
+  const int num_threads = 8;
+  const int pages_per_thread = 64;
+
+  // every thread writes its own pages and reads them back, interleaved with
+  // the others
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.push_back(std::thread([&disk_manager, tid] {
+      char data[PAGE_SIZE];
+      char buffer[PAGE_SIZE];
+      for (int round = 0; round < 4; ++round) {
+        for (int i = 0; i < pages_per_thread; ++i) {
+          page_id_t page_id = i * num_threads + tid;
+          memset(data, 'a' + (page_id + round) % 26, PAGE_SIZE);
+          disk_manager.WritePage(page_id, data);
+          disk_manager.ReadPage(page_id, buffer);
+          EXPECT_EQ(0, memcmp(data, buffer, PAGE_SIZE));
+        }
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * pages_per_thread, disk_manager.GetNumPages());
+
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(DiskManagerTest, AsyncTest) {
+  // the same with both backends, io_uring may fall back to the thread pool
+  for (AsyncIOType type : {AsyncIOType::IO_URING, AsyncIOType::THREAD_POOL}) {
+    remove("test.db");
+    DiskManager disk_manager("test.db");
+    disk_manager.SetAsyncIOType(type);
+    if (type == AsyncIOType::THREAD_POOL) {
+      EXPECT_EQ(AsyncIOType::THREAD_POOL, disk_manager.GetAsyncIOType());
+    }
+
+    // more requests than the queue holds, in one batch
+    const int num_pages = 3 * ASYNC_IO_QUEUE_DEPTH;
+    std::vector<char> data(num_pages * PAGE_SIZE);
+    std::vector<PageIORequest> requests;
+    for (int i = 0; i < num_pages; ++i) {
+      snprintf(&data[i * PAGE_SIZE], PAGE_SIZE, "page %d", i);
+      requests.push_back({true, i, &data[i * PAGE_SIZE], 1});
+    }
+    for (auto &future : disk_manager.SubmitPageIO(requests)) {
+      EXPECT_TRUE(future.get());
+    }
+    EXPECT_EQ(num_pages, disk_manager.GetNumPages());
+
+    std::vector<char> buffer(num_pages * PAGE_SIZE);
+    for (auto &request : requests) {
+      request.write_ = false;
+      request.data_ = &buffer[request.page_id_ * PAGE_SIZE];
+    }
+    for (auto &future : disk_manager.SubmitPageIO(requests)) {
+      EXPECT_TRUE(future.get());
+    }
+    EXPECT_EQ(data, buffer);
+
+    // several pages at once, and a read past the end of the file
+    EXPECT_TRUE(disk_manager.WritePagesAsync(num_pages, &data[0], 2).get());
+    EXPECT_EQ(num_pages + 2, disk_manager.GetNumPages());
+    char page[PAGE_SIZE];
+    EXPECT_TRUE(disk_manager.ReadPageAsync(num_pages + 1, page).get());
+    EXPECT_EQ(0, strcmp(page, "page 1"));
+    EXPECT_TRUE(disk_manager.ReadPageAsync(num_pages + 5, page).get());
+    EXPECT_EQ(0, page[0]);
+    EXPECT_TRUE(disk_manager.WritePageAsync(0, page).get());
+    disk_manager.ReadPage(0, page);
+    EXPECT_EQ(0, page[0]);
+  }
+
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(DiskManagerTest, MmapTest) {
+  remove("test.db");
+  char data[PAGE_SIZE];
+  char buffer[PAGE_SIZE];
+  {
+    DiskManager disk_manager("test.db");
+    disk_manager.SetReadMode(ReadMode::MMAP);
+    EXPECT_EQ(ReadMode::MMAP, disk_manager.GetReadMode());
+    // nothing in the file yet
+    EXPECT_EQ(nullptr, disk_manager.GetPageView(0));
+
+    // the mapping follows the file as it grows, and sees every write
+    for (int i = 0; i < 100; ++i) {
+      snprintf(data, PAGE_SIZE, "page %d", i);
+      disk_manager.WritePage(i, data);
+      const char *view = disk_manager.GetPageView(i);
+      ASSERT_NE(nullptr, view);
+      EXPECT_EQ(0, strcmp(view, data));
+    }
+    EXPECT_EQ(nullptr, disk_manager.GetPageView(100));
+    EXPECT_EQ(nullptr, disk_manager.GetPageView(INVALID_PAGE_ID));
+    const char *view = disk_manager.GetPageView(7);
+    strcpy(data, "rewritten");
+    disk_manager.WritePage(7, data);
+    EXPECT_EQ(0, strcmp(view, "rewritten"));
+    disk_manager.ReadPage(7, buffer);
+    EXPECT_EQ(0, strcmp(buffer, "rewritten"));
+
+    // past the end of the file reads behave as with pread
+    strcpy(buffer, "untouched");
+    disk_manager.ReadPage(200, buffer);
+    EXPECT_EQ(0, strcmp(buffer, "untouched"));
+    EXPECT_TRUE(disk_manager.ReadPageAsync(150, buffer).get());
+    EXPECT_EQ(0, buffer[0]);
+    std::vector<char> pages(3 * PAGE_SIZE);
+    EXPECT_TRUE(disk_manager.SubmitPageIO({{false, 40, pages.data(), 3}})[0]
+                    .get());
+    EXPECT_EQ(0, strcmp(&pages[2 * PAGE_SIZE], "page 42"));
+
+    disk_manager.SetReadMode(ReadMode::PREAD);
+    EXPECT_EQ(nullptr, disk_manager.GetPageView(7));
+  }
+
+  // an existing file is mapped as a whole
+  DiskManager disk_manager("test.db");
+  disk_manager.SetReadMode(ReadMode::MMAP);
+  disk_manager.ReadPage(99, buffer);
+  EXPECT_EQ(0, strcmp(buffer, "page 99"));
+
+  remove("test.db");
+  remove("test.log");
+  remove("test.fsm");
+}
+
+} // namespace cmudb
@@ -0,0 +1,200 @@
+/**
+ * free_space_map_test.cpp
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "disk/disk_manager.h"
+#include "disk/free_space_map.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(FreeSpaceMapTest, SampleTest) {
+  FreeSpaceMap map;
+  map.Open("test.fsm", PAGE_SIZE, 0, true);
+  for (page_id_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(i, map.Allocate());
+  }
+  EXPECT_EQ(10, map.GetNextPageId());
+  EXPECT_EQ(false, map.Deallocate(10));
+  EXPECT_EQ(false, map.Deallocate(INVALID_PAGE_ID));
+
+  EXPECT_EQ(true, map.Deallocate(7));
+  EXPECT_EQ(true, map.Deallocate(3));
+  EXPECT_EQ(false, map.Deallocate(3));
+  EXPECT_EQ(false, map.IsAllocated(3));
+  EXPECT_EQ(2, map.GetNumFreePages());
+  // the lowest free page first, then the file grows again
+  EXPECT_EQ(3, map.Allocate());
+  EXPECT_EQ(7, map.Allocate());
+  EXPECT_EQ(10, map.Allocate());
+  EXPECT_EQ(true, map.IsAllocated(3));
+  EXPECT_EQ(0, map.GetNumFreePages());
+
+  remove("test.fsm");
+}
+
+TEST(FreeSpaceMapTest, HintTest) {
+  FreeSpaceMap map;
+  map.Open("test.fsm", PAGE_SIZE, 0, true);
+  map.SetExtentAllocation(false);
+  for (page_id_t i = 0; i < 300; ++i) {
+    map.Allocate();
+  }
+  for (page_id_t page_id : {5, 100, 130, 200, 299}) {
+    EXPECT_EQ(true, map.Deallocate(page_id));
+  }
+  // nearest on either side, across words
+  EXPECT_EQ(130, map.Allocate(120));
+  EXPECT_EQ(100, map.Allocate(120));
+  EXPECT_EQ(200, map.Allocate(240));
+  EXPECT_EQ(299, map.Allocate(299));
+  EXPECT_EQ(5, map.Allocate(0));
+  EXPECT_EQ(300, map.Allocate(120));
+
+  remove("test.fsm");
+}
+
+TEST(FreeSpaceMapTest, ExtentTest) {
+  // two tables growing in turns
+  std::vector<page_id_t> first, second;
+  {
+    FreeSpaceMap map;
+    map.Open("test.fsm", PAGE_SIZE, 0, true);
+    first.push_back(map.Allocate());
+    second.push_back(map.Allocate());
+    for (int i = 0; i < 100; ++i) {
+      first.push_back(map.Allocate(first.back()));
+      second.push_back(map.Allocate(second.back()));
+    }
+    // the second table keeps the rest of the extent of its first page, the
+    // first one gets an extent of its own
+    EXPECT_EQ(64, first[1]);
+    EXPECT_EQ(2, second[1]);
+    // each table jumps only when it moves to a new extent
+    int jumps[2] = {0, 0};
+    for (int t = 0; t < 2; ++t) {
+      std::vector<page_id_t> &pages = t == 0 ? first : second;
+      for (size_t i = 1; i < pages.size(); ++i) {
+        if (pages[i] != pages[i - 1] + 1) {
+          jumps[t]++;
+          EXPECT_EQ(0, pages[i] % EXTENT_SIZE);
+        }
+      }
+    }
+    EXPECT_EQ(2, jumps[0]);
+    EXPECT_EQ(1, jumps[1]);
+    std::vector<bool> taken(map.GetNextPageId());
+    for (auto *pages : {&first, &second}) {
+      for (page_id_t page_id : *pages) {
+        EXPECT_EQ(false, taken[page_id]);
+        taken[page_id] = true;
+      }
+    }
+
+    // pages without a hint stay out of the reserved extents
+    page_id_t next_page_id = map.GetNextPageId();
+    EXPECT_EQ(next_page_id, map.Allocate());
+  }
+
+  // reservations are gone after a restart, the hint still finds the extent
+  FreeSpaceMap map;
+  map.Open("test.fsm", PAGE_SIZE, 0, false);
+  EXPECT_EQ(first.back() + 1, map.Allocate(first.back()));
+  EXPECT_EQ(second.back() + 1, map.Allocate(second.back()));
+
+  // a freed extent is reused as a whole
+  for (page_id_t page_id = 64; page_id < 128; ++page_id) {
+    EXPECT_EQ(true, map.Deallocate(page_id));
+  }
+  EXPECT_EQ(64, map.Allocate(second[1]));
+
+  remove("test.fsm");
+}
+
+TEST(FreeSpaceMapTest, PersistTest) {
+  remove("test.fsm");
+  // small map pages, so that the map spans several of them
+  const int page_size = 512;
+  const page_id_t num_pages = 3 * (8 * page_size - 64);
+  {
+    FreeSpaceMap map;
+    map.Open("test.fsm", page_size, 0, false);
+    for (page_id_t i = 0; i < num_pages; ++i) {
+      map.Allocate();
+    }
+    for (page_id_t i = 0; i < num_pages; i += 1000) {
+      EXPECT_EQ(true, map.Deallocate(i));
+    }
+  }
+  {
+    FreeSpaceMap map;
+    map.Open("test.fsm", page_size, 0, false);
+    EXPECT_EQ(num_pages, map.GetNextPageId());
+    EXPECT_EQ((num_pages + 999) / 1000, map.GetNumFreePages());
+    for (page_id_t i = 0; i < num_pages; ++i) {
+      EXPECT_EQ(i % 1000 != 0, map.IsAllocated(i));
+    }
+    EXPECT_EQ(9000, map.Allocate(8990));
+  }
+  {
+    // a new database
+    FreeSpaceMap map;
+    map.Open("test.fsm", page_size, 0, true);
+    EXPECT_EQ(0, map.GetNextPageId());
+    EXPECT_EQ(0, map.GetNumFreePages());
+  }
+
+  remove("test.fsm");
+}
+
+TEST(FreeSpaceMapTest, DiskManagerTest) {
+  remove("test.db");
+  char data[PAGE_SIZE] = "data";
+  {
+    DiskManager disk_manager("test.db");
+    for (page_id_t i = 0; i < 8; ++i) {
+      EXPECT_EQ(i, disk_manager.AllocatePage());
+      disk_manager.WritePage(i, data);
+    }
+    disk_manager.DeallocatePage(2);
+    disk_manager.DeallocatePage(5);
+  }
+  {
+    // the allocations survive the disk manager
+    DiskManager disk_manager("test.db");
+    EXPECT_EQ(2, disk_manager.GetNumFreePages());
+    EXPECT_EQ(5, disk_manager.AllocatePage(6));
+    EXPECT_EQ(2, disk_manager.AllocatePage());
+    EXPECT_EQ(8, disk_manager.AllocatePage());
+  }
+  remove("test.db");
+  {
+    // a map left behind does not apply to a new db file
+    DiskManager disk_manager("test.db");
+    EXPECT_EQ(0, disk_manager.AllocatePage());
+  }
+  remove("test.db");
+  remove("test.log");
+  remove("test.fsm");
+
+  // a database from before the map: its pages are all in use
+  {
+    DiskManager disk_manager("test.db");
+    disk_manager.WritePages(0, std::vector<char>(4 * PAGE_SIZE).data(), 4);
+  }
+  remove("test.fsm");
+  {
+    DiskManager disk_manager("test.db");
+    EXPECT_EQ(4, disk_manager.AllocatePage());
+  }
+
+  remove("test.db");
+  remove("test.log");
+  remove("test.fsm");
+}
+
+} // namespace cmudb
@@ -0,0 +1,124 @@
+/**
+ * direct_mapped_page_table_test.cpp
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "common/exception.h"
+#include "hash/direct_mapped_page_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(DirectMappedPageTableTest, SampleTest) {
+  DirectMappedPageTable<int> test;
+
+  // insert several key/value pairs, 0 marks an empty slot
+  for (int i = 0; i < 8; ++i) {
+    test.Insert(i, i + 1);
+  }
+  EXPECT_EQ(8, test.Size());
+
+  // find test
+  int result;
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(1, test.Find(i, result));
+    EXPECT_EQ(i + 1, result);
+  }
+  EXPECT_EQ(0, test.Find(8, result));
+  EXPECT_EQ(0, test.Find(-1, result));
+  EXPECT_EQ(0, test.Find(1 << 30, result));
+
+  // overwrite test
+  test.Insert(3, 100);
+  EXPECT_EQ(8, test.Size());
+  EXPECT_EQ(1, test.Find(3, result));
+  EXPECT_EQ(100, result);
+
+  // delete test
+  EXPECT_EQ(1, test.Remove(3));
+  EXPECT_EQ(0, test.Remove(3));
+  EXPECT_EQ(0, test.Find(3, result));
+  EXPECT_EQ(7, test.Size());
+
+  // far away ids grow the directory, the old entries stay
+  size_t capacity = test.GetCapacity();
+  test.Insert(100000, 7);
+  EXPECT_LT(capacity, test.GetCapacity());
+  EXPECT_EQ(1, test.Find(100000, result));
+  EXPECT_EQ(7, result);
+  EXPECT_EQ(1, test.Find(7, result));
+  EXPECT_EQ(8, result);
+  EXPECT_EQ(8, test.Size());
+
+  EXPECT_THROW(test.Insert(-1, 1), Exception);
+  EXPECT_THROW(test.Insert(1, 0), Exception);
+}
+
+TEST(DirectMappedPageTableTest, StrideTest) {
+  // the table of instance 1 out of 4
+  DirectMappedPageTable<int> test(4, 1);
+
+  for (int i = 1; i < 4000; i += 4) {
+    test.Insert(i, i);
+  }
+  EXPECT_EQ(1000, test.Size());
+  // 1000 ids of the instance fit into one leaf
+  EXPECT_EQ(4096, test.GetCapacity());
+
+  int result;
+  for (int i = 0; i < 4000; ++i) {
+    EXPECT_EQ(i % 4 == 1, test.Find(i, result));
+  }
+  EXPECT_EQ(0, test.Remove(2));
+  EXPECT_THROW(test.Insert(2, 2), Exception);
+}
+
+TEST(DirectMappedPageTableTest, ConcurrentTest) {
+  const int num_keys = 64;
+  DirectMappedPageTable<int> test;
+
+  // stable keys map to their negation, readers must always find them even
+  // while a writer keeps growing the directory
+  for (int i = 0; i < num_keys; ++i) {
+    test.Insert(i, -i - 1);
+  }
+
+  std::atomic<bool> done(false);
+  std::thread writer([&test, &done]() {
+    for (int round = 0; round < 20; ++round) {
+      for (int i = 0; i < 50; ++i)
+        test.Insert(num_keys + (round * 50 + i) * 1024, 1);
+      for (int i = 0; i < 50; ++i)
+        test.Remove(num_keys + (round * 50 + i) * 1024);
+    }
+    done = true;
+  });
+
+  std::vector<std::thread> readers;
+  std::vector<int> errors(4, 0);
+  for (int tid = 0; tid < 4; ++tid) {
+    readers.push_back(std::thread([&test, &done, &errors, tid]() {
+      int result;
+      while (!done) {
+        for (int i = 0; i < num_keys; ++i) {
+          if (!test.Find(i, result) || result != -i - 1)
+            errors[tid]++;
+        }
+      }
+    }));
+  }
+
+  writer.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  for (int tid = 0; tid < 4; ++tid) {
+    EXPECT_EQ(0, errors[tid]);
+  }
+  EXPECT_EQ(num_keys, test.Size());
+}
+
+} // namespace cmudb
@@ -0,0 +1,129 @@
+/**
+ * linear_probe_hash_table_test.cpp
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(LinearProbeHashTableTest, SampleTest) {
+  LinearProbeHashTable<int, int> test(8);
+  EXPECT_EQ(16, test.GetCapacity());
+
+  // insert several key/value pairs
+  for (int i = 0; i < 8; ++i) {
+    test.Insert(i * 16, i);
+  }
+  EXPECT_EQ(8, test.Size());
+
+  // find test
+  int result;
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(1, test.Find(i * 16, result));
+    EXPECT_EQ(i, result);
+  }
+  EXPECT_EQ(0, test.Find(1, result));
+
+  // overwrite test
+  test.Insert(32, 100);
+  EXPECT_EQ(8, test.Size());
+  EXPECT_EQ(1, test.Find(32, result));
+  EXPECT_EQ(100, result);
+
+  // delete test, every other key stays reachable
+  EXPECT_EQ(1, test.Remove(32));
+  EXPECT_EQ(0, test.Remove(32));
+  EXPECT_EQ(0, test.Find(32, result));
+  for (int i = 0; i < 8; ++i) {
+    if (i == 2)
+      continue;
+    EXPECT_EQ(1, test.Find(i * 16, result));
+    EXPECT_EQ(i, result);
+  }
+
+  // churn well past the capacity, removals leave no tombstones behind
+  for (int i = 0; i < 1000; ++i) {
+    test.Insert(1000 + i, i);
+    EXPECT_EQ(1, test.Find(1000 + i, result));
+    EXPECT_EQ(i, result);
+    EXPECT_EQ(1, test.Remove(1000 + i));
+  }
+  EXPECT_EQ(7, test.Size());
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(i != 2, test.Find(i * 16, result));
+  }
+}
+
+TEST(LinearProbeHashTableTest, ReserveTest) {
+  LinearProbeHashTable<int, int> test(4);
+  EXPECT_EQ(8, test.GetCapacity());
+  for (int i = 0; i < 4; ++i) {
+    test.Insert(i, i);
+  }
+
+  // a smaller bound keeps the slots, a larger one rehashes every entry
+  test.Reserve(2);
+  EXPECT_EQ(8, test.GetCapacity());
+  test.Reserve(20);
+  EXPECT_EQ(64, test.GetCapacity());
+  EXPECT_EQ(4, test.Size());
+  for (int i = 4; i < 20; ++i) {
+    test.Insert(i, i);
+  }
+  int result;
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_EQ(1, test.Find(i, result));
+    EXPECT_EQ(i, result);
+  }
+}
+
+TEST(LinearProbeHashTableTest, ConcurrentTest) {
+  const int num_keys = 64;
+  LinearProbeHashTable<int, int> test(2 * num_keys);
+
+  // stable keys map to their negation, readers must always find them even
+  // while a writer keeps shifting entries around them
+  for (int i = 0; i < num_keys; ++i) {
+    test.Insert(i, -i);
+  }
+
+  std::atomic<bool> done(false);
+  std::thread writer([&test, &done]() {
+    for (int round = 0; round < 2000; ++round) {
+      for (int i = num_keys; i < 2 * num_keys; ++i)
+        test.Insert(i, i);
+      for (int i = num_keys; i < 2 * num_keys; ++i)
+        test.Remove(i);
+    }
+    done = true;
+  });
+
+  std::vector<std::thread> readers;
+  std::vector<int> errors(4, 0);
+  for (int tid = 0; tid < 4; ++tid) {
+    readers.push_back(std::thread([&test, &done, &errors, tid]() {
+      int result;
+      while (!done) {
+        for (int i = 0; i < num_keys; ++i) {
+          if (!test.Find(i, result) || result != -i)
+            errors[tid]++;
+        }
+      }
+    }));
+  }
+
+  writer.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  for (int tid = 0; tid < 4; ++tid) {
+    EXPECT_EQ(0, errors[tid]);
+  }
+}
+
+} // namespace cmudb
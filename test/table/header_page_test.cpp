@@ -1,16 +1,16 @@
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 #include "buffer/buffer_pool_manager.h"
 #include "page/header_page.h"
 #include "gtest/gtest.h"
 
-// NOTE: when you running this test, make sure page size(config.h) is at least
-// 4096
 namespace cmudb {
 
 TEST(HeaderPageTest, UnitTest) {
-  DiskManager *disk_manager = new DiskManager("test.db");
+  // 27 records need a page of at least 4096 bytes
+  DiskManager *disk_manager = new DiskManager("test.db", 4096);
   BufferPoolManager *buffer_pool_manager =
       new BufferPoolManager(20, disk_manager);
   page_id_t header_page_id;
@@ -55,4 +55,84 @@ TEST(HeaderPageTest, UnitTest) {
   remove("test.db");
   remove("test.log");
 }
+
+TEST(HeaderPageTest, DatabaseParametersTest) {
+  {
+    DiskManager writer("test.db", 8192, 64);
+    BufferPoolManager bpm(writer.GetPoolSize(), &writer);
+    EXPECT_EQ(8192, bpm.GetPageSize());
+    page_id_t page_id;
+    HeaderPage *header = static_cast<HeaderPage *>(bpm.NewPage(page_id));
+    ASSERT_NE(nullptr, header);
+    header->Init(writer.GetPoolSize());
+    EXPECT_EQ(header->InsertRecord("table", 42), true);
+    bpm.UnpinPage(page_id, true);
+    EXPECT_EQ(true, bpm.FlushPage(page_id));
+  }
+
+  // reopening ignores the requested parameters in favour of the stored ones
+  DiskManager *disk_manager = new DiskManager("test.db");
+  EXPECT_EQ(8192, disk_manager->GetPageSize());
+  EXPECT_EQ(64, disk_manager->GetPoolSize());
+
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(disk_manager->GetPoolSize(), disk_manager);
+  HeaderPage *page = static_cast<HeaderPage *>(
+      buffer_pool_manager->FetchPage(HEADER_PAGE_ID));
+  ASSERT_NE(nullptr, page);
+  page_id_t root_id;
+  EXPECT_EQ(page->GetRootId("table", root_id), true);
+  EXPECT_EQ(42, root_id);
+  buffer_pool_manager->UnpinPage(HEADER_PAGE_ID, false);
+
+  delete buffer_pool_manager;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(HeaderPageTest, LegacyLayoutTest) {
+  remove("test.db");
+  remove("test.fsm");
+  // a header page from before the database parameters: the record count
+  // first, then the records
+  {
+    char data[PAGE_SIZE] = {};
+    int record_count = 1;
+    page_id_t root_id = 42;
+    memcpy(data, &record_count, 4);
+    strcpy(data + 4, "table");
+    memcpy(data + 36, &root_id, 4);
+    DiskManager writer("test.db");
+    writer.WritePage(HEADER_PAGE_ID, data);
+  }
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  EXPECT_EQ(PAGE_SIZE, disk_manager->GetPageSize());
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(20, disk_manager);
+  HeaderPage *page = static_cast<HeaderPage *>(
+      buffer_pool_manager->FetchPage(HEADER_PAGE_ID));
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(1, page->GetRecordCount());
+  page_id_t root_id;
+  EXPECT_EQ(page->GetRootId("table", root_id), true);
+  EXPECT_EQ(42, root_id);
+
+  // new records keep the old layout
+  EXPECT_EQ(page->InsertRecord("index", 7), true);
+  EXPECT_EQ(page->UpdateRecord("table", 43), true);
+  EXPECT_EQ(2, *reinterpret_cast<int *>(page->GetData()));
+  EXPECT_EQ(page->DeleteRecord("table"), true);
+  EXPECT_EQ(page->GetRootId("index", root_id), true);
+  EXPECT_EQ(7, root_id);
+  EXPECT_EQ(page->GetRootId("table", root_id), false);
+  buffer_pool_manager->UnpinPage(HEADER_PAGE_ID, true);
+
+  delete buffer_pool_manager;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+  remove("test.fsm");
+}
 } // namespace cmudb
@@ -1,6 +1,7 @@
 /**
  * virtual_table_test.cpp
  */
+#include "disk/disk_manager.h"
 #include "vtable/testing_vtable_util.h"
 
 namespace cmudb {
@@ -44,4 +45,31 @@ TEST(VtableTest, CreateTest) {
   remove("vtable.db");
   return;
 }
+
+TEST(VtableTest, DatabaseParametersTest) {
+  std::string db_file = "sqlite.db";
+  remove(db_file.c_str());
+  remove("vtable.db");
+  sqlite3 *db;
+  EXPECT_EQ(SQLITE_OK, sqlite3_open(db_file.c_str(), &db));
+  EXPECT_EQ(SQLITE_OK, sqlite3_enable_load_extension(db, 1));
+  char *zErrMsg = 0;
+  EXPECT_EQ(SQLITE_OK, sqlite3_load_extension(db, "libvtable", 0, &zErrMsg));
+
+  // the first table creates the database with the parameters it names
+  EXPECT_FALSE(ExecSQL(db, "CREATE VIRTUAL TABLE foo USING vtable ('a INT, "
+                           "b int', 'page_size=many')"));
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo USING vtable ('a INT, "
+                          "b int', 'page_size=4096', 'pool_size=32')"));
+  EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo VALUES(1, 2)"));
+  EXPECT_TRUE(ExecSQL(db, "SELECT * FROM foo"));
+  EXPECT_EQ(SQLITE_OK, sqlite3_close(db));
+
+  DiskManager disk_manager("vtable.db");
+  EXPECT_EQ(4096, disk_manager.GetPageSize());
+  EXPECT_EQ(32, disk_manager.GetPoolSize());
+
+  remove(db_file.c_str());
+  remove("vtable.db");
+}
 } // namespace cmudb